@@ -0,0 +1,42 @@
+# Sources of each font driver, for the host builds of the tests, benchmarks, examples and
+# tools. The ESP-IDF component compiles every source of src/ instead (see CMakeLists.txt).
+
+get_filename_component(TINY_FONT_SRC "${CMAKE_CURRENT_LIST_DIR}/../src" ABSOLUTE)
+
+set(TINYFONT_IBMF_SOURCES
+    ${TINY_FONT_SRC}/IBMFDriver/IBMFFont.cpp
+    ${TINY_FONT_SRC}/IBMFDriver/IBMFFontData.cpp
+    ${TINY_FONT_SRC}/IBMFDriver/IBMFFace.cpp
+    ${TINY_FONT_SRC}/IBMFDriver/RLEExtractor.cpp
+    ${TINY_FONT_SRC}/Misc/MappedFile.cpp
+    ${TINY_FONT_SRC}/Misc/FontLog.cpp
+)
+
+set(TINYFONT_TTF_SOURCES
+    ${TINY_FONT_SRC}/TTFDriver/TTFFont.cpp
+    ${TINY_FONT_SRC}/TTFDriver/TTFFontData.cpp
+    ${TINY_FONT_SRC}/TTFDriver/TTFCache.cpp
+    ${TINY_FONT_SRC}/TTFDriver/TTFGlyphStore.cpp
+    ${TINY_FONT_SRC}/TTFDriver/TTFAtlas.cpp
+    ${TINY_FONT_SRC}/TTFDriver/TTFOutlineCache.cpp
+    ${TINY_FONT_SRC}/TTFDriver/TTFMemory.cpp
+    ${TINY_FONT_SRC}/TTFDriver/TTFNotoSansLight.cpp
+    ${TINY_FONT_SRC}/TTFDriver/TTFFileFontData.cpp
+    ${TINY_FONT_SRC}/TTFDriver/TTFStrike.cpp
+    ${TINY_FONT_SRC}/TTFDriver/TTFStrikeFontData.cpp
+    ${TINY_FONT_SRC}/TTFDriver/TTFStreamFontData.cpp
+    ${TINY_FONT_SRC}/TTFDriver/TTFBlockStream.cpp
+    ${TINY_FONT_SRC}/Misc/MappedFile.cpp
+    ${TINY_FONT_SRC}/Misc/FontLog.cpp
+)
+
+# Added to the targets built with CONFIG_TINYFONT_TRACE
+set(TINYFONT_TRACE_SOURCES
+    ${TINY_FONT_SRC}/Misc/FontTrace.cpp
+)
+
+# Strike builder of tools/ttf_strike, for the host targets built with
+# CONFIG_TINYFONT_TTF_STRIKE_ACCESS
+get_filename_component(TINYFONT_STRIKE_WRITER_DIR "${CMAKE_CURRENT_LIST_DIR}/../tools/ttf_strike"
+    ABSOLUTE)
+set(TINYFONT_STRIKE_WRITER_SOURCES ${TINYFONT_STRIKE_WRITER_DIR}/TTFStrikeWriter.cpp)
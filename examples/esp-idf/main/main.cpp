@@ -96,7 +96,9 @@ extern "C" void app_main(void) {
     heap_caps_free(canvas.pixels);
 #endif
 
+    // The drivers' log messages are printed here, out of the rendering.
     while (true) {
+        font_log::drain();
         vTaskDelay(pdMS_TO_TICKS(1000));
     }
 }
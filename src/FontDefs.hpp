@@ -3,8 +3,26 @@
 #include <cstdio>
 #include <inttypes.h>
 
+#include "Misc/FontLog.hpp"
+#include "Misc/FontStats.hpp"
+
 // These are the definitions that are common to both IBMF and TTF Font types
 
+#if CONFIG_TINYFONT_DEFERRED_LOG
+// Recorded in font_log's ring buffer, printed by font_log::drain() (see Misc/FontLog.hpp)
+#ifndef LOGI
+#define LOGI(format, ...) FONT_LOG(font_log::Level::INFO, format, ##__VA_ARGS__)
+#endif
+#ifndef LOGW
+#define LOGW(format, ...) FONT_LOG(font_log::Level::WARNING, format, ##__VA_ARGS__)
+#endif
+#ifndef LOGE
+#define LOGE(format, ...) FONT_LOG(font_log::Level::ERROR, format, ##__VA_ARGS__)
+#endif
+#ifndef LOGD
+#define LOGD(format, ...) FONT_LOG(font_log::Level::DEBUG, format, ##__VA_ARGS__)
+#endif
+#else
 #ifndef LOGI
 #define LOGI(format, ...) std::printf("INFO: " format "\n", ##__VA_ARGS__)
 #endif
@@ -17,6 +35,7 @@
 #ifndef LOGD
 #define LOGD(format, ...) std::printf("DEBUG: " format "\n", ##__VA_ARGS__)
 #endif
+#endif
 
 namespace font_defs {
 
@@ -35,7 +54,59 @@ struct Pos {
 };
 
 typedef uint8_t *MemoryPtr;
-enum class PixelResolution : uint8_t { ONE_BIT, EIGHT_BITS, SIXTEEN_BITS, TWENTYFOUR_BITS };
+
+// New resolutions are appended: the values are kept in the glyphs' cache snapshots.
+enum class PixelResolution : uint8_t {
+    ONE_BIT,
+    EIGHT_BITS,
+    SIXTEEN_BITS,
+    TWENTYFOUR_BITS,
+    TWO_BITS,
+    FOUR_BITS
+};
+
+/// @brief Bits per pixel of a display bitmap of **resolution**.
+inline constexpr auto bitsPerPixel(PixelResolution resolution) -> int {
+    switch (resolution) {
+    case PixelResolution::ONE_BIT:
+        return 1;
+    case PixelResolution::TWO_BITS:
+        return 2;
+    case PixelResolution::FOUR_BITS:
+        return 4;
+    case PixelResolution::SIXTEEN_BITS:
+        return 16;
+    case PixelResolution::TWENTYFOUR_BITS:
+        return 24;
+    default:
+        return 8;
+    }
+}
+
+/// @brief True for the resolutions with several pixels per byte, the leftmost pixel being in
+/// the most significant bits.
+inline constexpr auto isPackedResolution(PixelResolution resolution) -> bool {
+    return bitsPerPixel(resolution) < 8;
+}
+
+/// @brief Bits per pixel of a glyph bitmap of the font **resolution**. Glyphs of the 16 and
+/// 24 bits resolutions are 8 bits grayscale.
+inline constexpr auto glyphBitsPerPixel(PixelResolution resolution) -> int {
+    return isPackedResolution(resolution) ? bitsPerPixel(resolution) : 8;
+}
+
+/// @brief Bytes per row of a glyph bitmap **width** pixels wide.
+inline constexpr auto glyphRowBytes(int width, PixelResolution resolution) -> uint16_t {
+    return static_cast<uint16_t>((width * glyphBitsPerPixel(resolution) + 7) >> 3);
+}
+
+/// @brief Pitch of a canvas **width** pixels wide: in bytes up to 8 bits per pixel, in pixels
+/// for the 16 and 24 bits resolutions.
+inline constexpr auto canvasPitch(int width, PixelResolution resolution) -> uint16_t {
+    return isPackedResolution(resolution)
+               ? static_cast<uint16_t>((width * bitsPerPixel(resolution) + 7) >> 3)
+               : static_cast<uint16_t>(width);
+}
 
 // For 8-bit screen:
 //
@@ -45,12 +116,21 @@ enum class PixelResolution : uint8_t { ONE_BIT, EIGHT_BITS, SIXTEEN_BITS, TWENTY
 //     ONE_BIT (Monochome)
 //   - if IMBF_SUPPORT: only ONE_BIT is available for Font Resolution
 //
+// Grayscale e-ink panels take TWO_BITS or FOUR_BITS packed pixels, 0 being black. With
+// CONFIG_TINYFONT_TTF, the glyphs are then cached and drawn at the same resolution.
+//
 // For the first version of the Sol Reader, only ONE_BIT is available for both Display Screen and
 // Font resolution, for both CONFIG_TINYFONT_IBMF and CONFIG_TINYFONT_TTF
 
 #if CONFIG_TINYFONT_PIXEL_RESOLUTION_ONE_BIT
 const constexpr PixelResolution DEFAULT_DISPLAY_PIXEL_RESOLUTION = PixelResolution::ONE_BIT;
 const constexpr PixelResolution DEFAULT_FONT_PIXEL_RESOLUTION = PixelResolution::ONE_BIT;
+#elif CONFIG_TINYFONT_PIXEL_RESOLUTION_TWO_BIT
+const constexpr PixelResolution DEFAULT_DISPLAY_PIXEL_RESOLUTION = PixelResolution::TWO_BITS;
+const constexpr PixelResolution DEFAULT_FONT_PIXEL_RESOLUTION = PixelResolution::TWO_BITS;
+#elif CONFIG_TINYFONT_PIXEL_RESOLUTION_FOUR_BIT
+const constexpr PixelResolution DEFAULT_DISPLAY_PIXEL_RESOLUTION = PixelResolution::FOUR_BITS;
+const constexpr PixelResolution DEFAULT_FONT_PIXEL_RESOLUTION = PixelResolution::FOUR_BITS;
 #elif CONFIG_TINYFONT_PIXEL_RESOLUTION_EIGHT_BIT
 const constexpr PixelResolution DEFAULT_DISPLAY_PIXEL_RESOLUTION = PixelResolution::EIGHT_BITS;
 const constexpr PixelResolution DEFAULT_FONT_PIXEL_RESOLUTION = PixelResolution::EIGHT_BITS;
@@ -66,6 +146,8 @@ const constexpr PixelResolution DEFAULT_FONT_PIXEL_RESOLUTION = PixelResolution:
 
 const constexpr bool TINYFONT_PIXEL_RESOLUTION_OK =
     ((DEFAULT_DISPLAY_PIXEL_RESOLUTION == PixelResolution::SIXTEEN_BITS) ||
+     (DEFAULT_DISPLAY_PIXEL_RESOLUTION == PixelResolution::TWO_BITS) ||
+     (DEFAULT_DISPLAY_PIXEL_RESOLUTION == PixelResolution::FOUR_BITS) ||
      (DEFAULT_DISPLAY_PIXEL_RESOLUTION == PixelResolution::EIGHT_BITS) ||
      (DEFAULT_DISPLAY_PIXEL_RESOLUTION == PixelResolution::TWENTYFOUR_BITS) ||
      (DEFAULT_FONT_PIXEL_RESOLUTION == PixelResolution::ONE_BIT));
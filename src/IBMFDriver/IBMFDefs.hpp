@@ -20,6 +20,11 @@ const constexpr int K_BUFF_HEIGHT = 25;
 const constexpr int K_ORIGIN_X = 5;
 const constexpr int K_ORIGIN_Y = 19;
 const constexpr int KERNING_SIZE = 1;
+
+// Number of glyph pairs whose optical kerning is kept by a face
+#ifndef CONFIG_TINYFONT_IBMF_OPTICAL_KERN_COUNT
+#define CONFIG_TINYFONT_IBMF_OPTICAL_KERN_COUNT 4096
+#endif
 #endif
 
 // clang-format off
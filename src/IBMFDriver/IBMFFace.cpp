@@ -59,6 +59,7 @@ auto IBMFFace::load(const MemoryPtr dataStart, const int dataLength, FontFormat
 /// @return True if a ligature was found, false otherwise.
 ///
 auto IBMFFace::ligKern(const GlyphCode glyphCode1, GlyphCode *glyphCode2, FIX16 *kern) -> bool {
+    font_stats::ScopedTimer timer(StatId::LIG_KERN, glyphCode1, *glyphCode2);
 
     if ((glyphCode1 >= faceHeader_->glyphCount) || (*glyphCode2 >= faceHeader_->glyphCount)) {
         *kern = 0;
@@ -105,6 +106,16 @@ auto IBMFFace::ligKern(const GlyphCode glyphCode1, GlyphCode *glyphCode2, FIX16
 
 #if OPTICAL_KERNING
 
+    // Computing an optical kerning requires both glyph bitmaps to be decoded: the result
+    // is kept for the next time the pair is seen.
+    uint32_t pairKey = (static_cast<uint32_t>(glyphCode1) << 16) | *glyphCode2;
+    if (FIX16 *cachedKern = opticalKerns_.find(pairKey); cachedKern != nullptr) {
+        *kern = *cachedKern;
+        return false;
+    }
+
+    font_stats::ScopedTimer opticalTimer(StatId::OPTICAL_KERN, glyphCode1, *glyphCode2);
+
     typedef int32_t FIX32;
 
 #define FRACT_BITS 10
@@ -419,6 +430,10 @@ auto IBMFFace::ligKern(const GlyphCode glyphCode1, GlyphCode *glyphCode2, FIX16
     // }
 
     *kern = static_cast<FIX16>(kerning >> 4); // Convert to FIX16
+    if (opticalKerns_.size() >= MAX_OPTICAL_KERN_COUNT) {
+        opticalKerns_.clear();
+    }
+    opticalKerns_.insert(pairKey, *kern);
 #endif
     // LOGD("Optical Kerning End");
     return false;
@@ -525,7 +540,11 @@ auto IBMFFace::getGlyph(GlyphCode glyphCode, Glyph &appGlyph, bool loadBitmap, b
         Pos outPos = Pos(atPos.x + glyphOffsets.x, atPos.y + glyphOffsets.y);
         // std::cout << "inPos: [" << atPos.x << ", " << atPos.y << "], outPos: [" << outPos.x
         //           << ", " << outPos.y << "] " << std::endl;
-        rle.retrieveBitmap(glyphBitmap, appGlyph.bitmap, outPos, glyphInfo->rleMetrics, inverted);
+        {
+            font_stats::ScopedTimer timer(StatId::RLE_DECODE, glyphCode);
+            rle.retrieveBitmap(glyphBitmap, appGlyph.bitmap, outPos, glyphInfo->rleMetrics,
+                               inverted);
+        }
         if (!caching) {
             showBitmap(appGlyph.bitmap);
         }
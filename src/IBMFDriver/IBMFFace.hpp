@@ -6,6 +6,7 @@
 #include <memory>
 #include <new>
 
+#include "../Misc/FlatHashMap.hpp"
 #include "IBMFDefs.hpp"
 #include "RLEExtractor.hpp"
 
@@ -30,6 +31,15 @@ private:
     PixelsPoolPtr pixelsPool_{nullptr};
     LigKernStepsPtr ligKernSteps_{nullptr};
 
+#if OPTICAL_KERNING
+    // Over this count of glyph pairs, the optical kerning values are emptied before receiving a
+    // new one.
+    static constexpr uint32_t MAX_OPTICAL_KERN_COUNT = CONFIG_TINYFONT_IBMF_OPTICAL_KERN_COUNT;
+
+    // Optical kerning values already computed, indexed by (glyphCode1 << 16) | glyphCode2
+    FlatHashMap<FIX16> opticalKerns_;
+#endif
+
 public:
     IBMFFace() = default;
 
@@ -88,6 +98,23 @@ public:
 
     auto ligKern(GlyphCode glyphCode1, GlyphCode *glyphCode2, FIX16 *kern) -> bool;
 
+    /// @brief Number of glyph pairs for which an optical kerning value is kept.
+    [[nodiscard]] inline auto getOpticalKernCount() const -> uint32_t {
+#if OPTICAL_KERNING
+        return opticalKerns_.size();
+#else
+        return 0;
+#endif
+    }
+
+    /// @brief Forget the optical kerning values computed so far, returning their memory to the
+    /// heap.
+    inline void clearOpticalKerns() {
+#if OPTICAL_KERNING
+        opticalKerns_.reset();
+#endif
+    }
+
     auto getGlyph(GlyphCode glyphCode, Glyph &appGlyph, bool loadBitmap, bool caching = true,
                   Pos atPos = Pos(0, 0), bool inverted = false) -> bool;
 
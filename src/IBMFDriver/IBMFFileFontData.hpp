@@ -0,0 +1,29 @@
+#pragma once
+
+#if CONFIG_TINYFONT_IBMF
+
+#include "../Misc/MappedFile.hpp"
+#include "IBMFFontData.hpp"
+
+/**
+ * @brief IBMF font data read from a font file.
+ *
+ * The file is mapped in memory (see MappedFile) and the faces are read in place.
+ */
+class IBMFFileFontData : public FontData {
+    MappedFile file_{};
+
+public:
+    explicit IBMFFileFontData(const char *path) noexcept : file_(path) {
+        if (!file_.isOpen()) {
+            LOGE("Unable to map IBMF font file %s.", path);
+        } else if (!load(file_.data(), static_cast<uint32_t>(file_.size()))) {
+            LOGE("Font data not recognized!");
+        }
+    }
+
+    IBMFFileFontData(const IBMFFileFontData &) = delete;
+    auto operator=(const IBMFFileFontData &) -> IBMFFileFontData & = delete;
+};
+
+#endif
@@ -54,6 +54,7 @@ auto Font::ligKernUTF8Map(const std::string &line, LigKernMappingHandler handler
 // Returns the x position at the end of string
 auto Font::drawSingleLineOfText(ibmf_defs::Bitmap &canvas, ibmf_defs::Pos pos,
                                 const std::string &line, bool inverted) const -> int {
+    font_stats::ScopedTimer timer(StatId::DRAW, line);
 
     ibmf_defs::Pos atPos = pos;
 
@@ -113,6 +114,7 @@ auto Font::drawSingleLineOfText(ibmf_defs::Bitmap &canvas, ibmf_defs::Pos pos,
 }
 
 auto Font::getTextSize(const std::string &buffer) const -> ibmf_defs::Dim {
+    font_stats::ScopedTimer timer(StatId::MEASURE, buffer);
     // LOGD("getTextSize(): %s", buffer.c_str());
     if constexpr (IBMF_TRACING) {
         LOGD("getTextSize()");
@@ -155,6 +157,7 @@ auto Font::getTextSize(const std::string &buffer) const -> ibmf_defs::Dim {
 }
 
 auto Font::getTextWidth(const std::string &buffer) -> int {
+    font_stats::ScopedTimer timer(StatId::MEASURE, buffer);
     if constexpr (IBMF_TRACING) {
         LOGD("getTextWidth()");
     }
@@ -223,6 +226,16 @@ auto Font::toChar32(const char **str) -> char32_t {
     return res;
 }
 
+auto Font::prefetch(const std::string &text) const -> uint32_t {
+    uint32_t count = 0;
+    if (isInitialized()) {
+        uint32_t before = fontData_->getFace(faceIndex_)->getOpticalKernCount();
+        ligKernUTF8Map(text, [](GlyphCode, FIX16, bool, bool) {});
+        count = fontData_->getFace(faceIndex_)->getOpticalKernCount() - before;
+    }
+    return count;
+}
+
 auto Font::getTextHeight(const std::string &buffer) const -> int {
     if constexpr (IBMF_TRACING) {
         LOGD("getTextHeight()");
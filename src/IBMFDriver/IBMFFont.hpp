@@ -3,9 +3,9 @@
 #if CONFIG_TINYFONT_IBMF
 
 #include <cstdio>
-#include <functional>
 
 #include "../Font.hpp"
+#include "../Misc/FunctionRef.hpp"
 #include "../UTF8Iterator.hpp"
 #include "IBMFFontData.hpp"
 
@@ -18,7 +18,7 @@ private:
     // Maximum size of an allocated buffer to do vsnprintf formatting
     static constexpr int MAX_SIZE = 100;
 
-    typedef std::function<void(GlyphCode, FIX16, bool, bool)> const &LigKernMappingHandler;
+    typedef FunctionRef<void(GlyphCode, FIX16, bool, bool)> LigKernMappingHandler;
 
     /// @brief Ligature/Kerning/UTF8 Mapper
     ///
@@ -93,6 +93,17 @@ public:
 
     [[nodiscard]] auto getTextHeight(const std::string &buffer) const -> int;
 
+    /// @brief Compute ahead of time the optical kerning of the glyph pairs present in **text**.
+    ///
+    /// IBMF glyphs are decoded straight from the font data while drawing. What is costly
+    /// is the optical kerning, that decodes both glyphs of each pair: the values computed
+    /// here are kept by the face for the next renderings.
+    ///
+    /// @param text In. UTF8 string of characters, such as the content of the next page.
+    /// @return The number of glyph pairs that were not yet known.
+    ///
+    auto prefetch(const std::string &text) const -> uint32_t;
+
     // Non-validating algorithm
     auto toChar32(const char **str) -> char32_t;
 
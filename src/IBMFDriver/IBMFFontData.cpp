@@ -140,6 +140,7 @@ auto FontData::load(MemoryPtr fontData, uint32_t length) -> bool {
  * @return The internal representation of CodePoint
  */
 [[nodiscard]] auto FontData::translate(char32_t codePoint) const -> GlyphCode {
+    font_stats::ScopedTimer timer(StatId::TRANSLATE, codePoint);
     GlyphCode glyphCode = unknownGlyphCode_;
 
 #if LATIN_SUPPORT
@@ -234,10 +235,8 @@ auto FontData::load(MemoryPtr fontData, uint32_t length) -> bool {
         }
     }
 
-    // The following test could generates many entries in the log, depending on the quantity of
-    // unknown code points received to be translated. Could be removed or disabled if required.
     if ((codePoint != UNKNOWN_CODEPOINT) && (glyphCode == unknownGlyphCode_)) {
-        LOGW("Unknown Code Point received: U+%05" PRIx32, uint32_t(codePoint));
+        font_log::countUnknownCodePoint(codePoint);
     }
 
     return glyphCode;
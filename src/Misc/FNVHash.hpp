@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// 32 bits FNV-1a hash. Not a cryptographic hash: it is used to identify font data and to
+// detect corrupted cache snapshots.
+
+const constexpr uint32_t FNV_OFFSET_BASIS = 2166136261U;
+const constexpr uint32_t FNV_PRIME = 16777619U;
+
+/// @brief Hash **size** bytes at **data**, continuing from a previous **hash** if any.
+inline auto fnv1a(const void *data, std::size_t size, uint32_t hash = FNV_OFFSET_BASIS)
+    -> uint32_t {
+    auto bytes = static_cast<const uint8_t *>(data);
+    for (std::size_t i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * FNV_PRIME;
+    }
+    return hash;
+}
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "SpiramAllocator.hpp"
+
+/**
+ * @brief Open-addressing hash map with 32 bits keys.
+ *
+ * Entries are kept inline in a single power-of-two sized table and collisions are
+ * resolved by linear probing, so a lookup is a single probe in the common case and
+ * never chases pointers. Erased entries are removed by shifting back the entries
+ * that follow them in their probe sequence: there is no tombstone to skip.
+ *
+ * The key 0xFFFFFFFF is reserved to identify empty slots. The table comes from the
+ * SPIRAM heap when CONFIG_TINYFONT_USE_SPIRAM is set.
+ */
+template <typename V>
+class FlatHashMap {
+    static_assert(std::is_trivially_copyable_v<V>, "FlatHashMap values are copied as raw memory");
+
+public:
+    static constexpr uint32_t EMPTY_KEY = 0xFFFFFFFF;
+
+private:
+    struct Slot {
+        uint32_t key;
+        V value;
+    };
+
+    static constexpr uint32_t MIN_CAPACITY_SHIFT = 6;
+
+    Slot *slots_{nullptr};
+    uint32_t mask_{0};
+    uint32_t shift_{32};
+    uint32_t size_{0};
+
+    [[nodiscard]] inline auto slotIndex(uint32_t key) const -> uint32_t {
+        // Fibonacci hashing: the multiplication spreads the key bits into the top bits.
+        return (key * 2654435769U) >> shift_;
+    }
+
+    auto rehash(uint32_t capacityShift) -> bool {
+        uint32_t capacity = 1U << capacityShift;
+        auto slots = static_cast<Slot *>(fontMalloc(sizeof(Slot) * capacity));
+        if (slots == nullptr) {
+            return false;
+        }
+        for (uint32_t i = 0; i < capacity; i++) {
+            slots[i].key = EMPTY_KEY;
+        }
+
+        Slot *oldSlots = slots_;
+        uint32_t oldCapacity = (oldSlots == nullptr) ? 0 : mask_ + 1;
+
+        slots_ = slots;
+        mask_ = capacity - 1;
+        shift_ = 32 - capacityShift;
+
+        for (uint32_t i = 0; i < oldCapacity; i++) {
+            if (oldSlots[i].key != EMPTY_KEY) {
+                uint32_t idx = slotIndex(oldSlots[i].key);
+                while (slots_[idx].key != EMPTY_KEY) {
+                    idx = (idx + 1) & mask_;
+                }
+                slots_[idx] = oldSlots[i];
+            }
+        }
+
+        if (oldSlots != nullptr) {
+            fontFree(oldSlots);
+        }
+        return true;
+    }
+
+public:
+    FlatHashMap() = default;
+
+    ~FlatHashMap() { reset(); }
+
+    FlatHashMap(const FlatHashMap &) = delete;
+    auto operator=(const FlatHashMap &) -> FlatHashMap & = delete;
+
+    [[nodiscard]] inline auto size() const -> uint32_t { return size_; }
+    [[nodiscard]] inline auto capacity() const -> uint32_t {
+        return (slots_ == nullptr) ? 0 : mask_ + 1;
+    }
+
+    [[nodiscard]] inline auto find(uint32_t key) -> V * {
+        if (slots_ != nullptr) {
+            uint32_t idx = slotIndex(key);
+            while (true) {
+                Slot &slot = slots_[idx];
+                if (slot.key == key) {
+                    return &slot.value;
+                }
+                if (slot.key == EMPTY_KEY) {
+                    return nullptr;
+                }
+                idx = (idx + 1) & mask_;
+            }
+        }
+        return nullptr;
+    }
+
+    /// @brief Insert or replace the value associated with **key**.
+    /// @return false if the table could not be grown.
+    auto insert(uint32_t key, const V &value) -> bool {
+        // Keep the load factor under 3/4
+        if (((size_ + 1) << 2) > (capacity() * 3)) {
+            uint32_t capacityShift = (slots_ == nullptr) ? MIN_CAPACITY_SHIFT : 33 - shift_;
+            if (!rehash(capacityShift)) {
+                return false;
+            }
+        }
+
+        uint32_t idx = slotIndex(key);
+        while (slots_[idx].key != EMPTY_KEY) {
+            if (slots_[idx].key == key) {
+                slots_[idx].value = value;
+                return true;
+            }
+            idx = (idx + 1) & mask_;
+        }
+        slots_[idx].key = key;
+        slots_[idx].value = value;
+        size_++;
+        return true;
+    }
+
+    auto erase(uint32_t key) -> bool {
+        if (slots_ == nullptr) {
+            return false;
+        }
+
+        uint32_t idx = slotIndex(key);
+        while (slots_[idx].key != key) {
+            if (slots_[idx].key == EMPTY_KEY) {
+                return false;
+            }
+            idx = (idx + 1) & mask_;
+        }
+
+        // Backward shift: move up every following entry that would otherwise become
+        // unreachable from its home slot.
+        uint32_t next = (idx + 1) & mask_;
+        while (slots_[next].key != EMPTY_KEY) {
+            uint32_t home = slotIndex(slots_[next].key);
+            if (((next - home) & mask_) >= ((next - idx) & mask_)) {
+                slots_[idx] = slots_[next];
+                idx = next;
+            }
+            next = (next + 1) & mask_;
+        }
+        slots_[idx].key = EMPTY_KEY;
+        size_--;
+        return true;
+    }
+
+    /// @brief Remove all entries, keeping the table allocated.
+    void clear() {
+        for (uint32_t i = 0; i < capacity(); i++) {
+            slots_[i].key = EMPTY_KEY;
+        }
+        size_ = 0;
+    }
+
+    /// @brief Remove all entries and return the table to the heap.
+    void reset() {
+        if (slots_ != nullptr) {
+            fontFree(slots_);
+        }
+        slots_ = nullptr;
+        mask_ = 0;
+        shift_ = 32;
+        size_ = 0;
+    }
+
+    template <typename F>
+    void forEach(F handler) {
+        for (uint32_t i = 0; i < capacity(); i++) {
+            if (slots_[i].key != EMPTY_KEY) {
+                handler(slots_[i].key, slots_[i].value);
+            }
+        }
+    }
+};
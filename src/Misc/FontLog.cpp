@@ -0,0 +1,381 @@
+#include "FontLog.hpp"
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+
+#include "../FontDefs.hpp"
+
+#if CONFIG_TINYFONT_DEFERRED_LOG
+#if defined(ESP_PLATFORM)
+#include <esp_timer.h>
+#else
+#include <chrono>
+#endif
+#endif
+
+namespace font_log {
+
+namespace {
+
+const constexpr int UNKNOWN_SLOTS = 16;
+const constexpr int MESSAGE_SIZE = 256;
+
+struct UnknownCodePoint {
+    std::atomic<uint32_t> key{0}; // 1 + the code point, 0 if the slot is free
+    std::atomic<uint32_t> count{0};
+};
+
+std::atomic<Sink> sink{nullptr};
+std::atomic_flag draining = ATOMIC_FLAG_INIT;
+UnknownCodePoint unknownCodePoints[UNKNOWN_SLOTS];
+std::atomic<uint32_t> otherUnknownCount{0}; // Occurrences of the code points without a slot
+
+auto getLevelName(Level level) -> const char * {
+    switch (level) {
+    case Level::ERROR:
+        return "ERROR";
+    case Level::WARNING:
+        return "WARNING";
+    case Level::INFO:
+        return "INFO";
+    default:
+        return "DEBUG";
+    }
+}
+
+void emit(Level level, const char *message) {
+    Sink current = sink.load(std::memory_order_acquire);
+    if (current != nullptr) {
+        current(level, message);
+    } else {
+        std::printf("%s: %s\n", getLevelName(level), message);
+    }
+}
+
+// Append the formatted text to the **size** bytes of **buffer** from **length**, that is kept
+// under size.
+template <typename... Args>
+void append(char *buffer, int size, int &length, const char *format, Args... args) {
+    int written = std::snprintf(buffer + length, size - length, format, args...);
+    if (written > 0) {
+        length = (length + written < size) ? length + written : size - 1;
+    }
+}
+
+auto summarizeUnknownCodePoints() -> uint32_t {
+    char buffer[MESSAGE_SIZE];
+    int length = 0;
+    int listed = 0;
+    append(buffer, MESSAGE_SIZE, length, "%s", "Unknown code points received:");
+    for (UnknownCodePoint &slot : unknownCodePoints) {
+        uint32_t key = slot.key.load(std::memory_order_acquire);
+        if (key == 0) {
+            continue;
+        }
+        // Counts are approximate when code points are received while draining.
+        uint32_t count = slot.count.exchange(0, std::memory_order_relaxed);
+        slot.key.store(0, std::memory_order_release);
+        append(buffer, MESSAGE_SIZE, length, "%s U+%04" PRIX32 " (%" PRIu32 ")",
+               (listed > 0) ? "," : "", key - 1, count);
+        listed++;
+    }
+    uint32_t others = otherUnknownCount.exchange(0, std::memory_order_relaxed);
+    if (others > 0) {
+        append(buffer, MESSAGE_SIZE, length, " and %" PRIu32 " others", others);
+    }
+    if ((listed == 0) && (others == 0)) {
+        return 0;
+    }
+    emit(Level::WARNING, buffer);
+    return 1;
+}
+
+// Count an occurrence of the code point of **key** in its slot, taking a free slot for its
+// first occurrence. Returns false if no slot is free.
+auto countInSlot(uint32_t key) -> bool {
+    for (UnknownCodePoint &slot : unknownCodePoints) {
+        uint32_t current = slot.key.load(std::memory_order_acquire);
+        if ((current == 0) &&
+            slot.key.compare_exchange_strong(current, key, std::memory_order_acq_rel)) {
+            slot.count.fetch_add(1, std::memory_order_relaxed);
+            LOGW("Unknown Code Point received: U+%05" PRIx32, key - 1);
+            return true;
+        }
+        if (current == key) {
+            slot.count.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+#if CONFIG_TINYFONT_DEFERRED_LOG
+
+struct Record {
+    // 1 + the index of the message when written, 0 while being written. As the ring wraps
+    // around, it tells the drain whether the message is the one expected or a newer one.
+    std::atomic<uint32_t> sequence{0};
+    Message message;
+};
+
+const constexpr uint32_t WRITING = 0;
+
+std::atomic<uint32_t> head{0}; // Index of the next message to record
+uint32_t tail = 0;             // Index of the next message to drain, under the draining flag
+Record ring[RING_SIZE];
+std::atomic<Clock> clock{nullptr};
+
+auto milliseconds() -> uint32_t {
+    if (Clock current = clock.load(std::memory_order_acquire); current != nullptr) {
+        return current();
+    }
+#if defined(ESP_PLATFORM)
+    return static_cast<uint32_t>(esp_timer_get_time() / 1000);
+#else
+    return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                                     std::chrono::steady_clock::now().time_since_epoch())
+                                     .count());
+#endif
+}
+
+// Sign or zero extend an integer argument of **size** bytes, as printf reads it for a
+// signed or an unsigned conversion.
+auto toSigned(uint64_t value, uint8_t size) -> long long {
+    if (size >= sizeof(uint64_t)) {
+        return static_cast<long long>(value);
+    }
+    int shift = 64 - (size * 8);
+    return static_cast<long long>(value << shift) >> shift;
+}
+
+auto toUnsigned(uint64_t value, uint8_t size) -> unsigned long long {
+    if (size >= sizeof(uint64_t)) {
+        return value;
+    }
+    return value & ((uint64_t(1) << (size * 8)) - 1);
+}
+
+// The printf subset used by the drivers: flags, width and precision are kept, the length
+// modifiers replaced by the ones of the values recorded.
+void format(const Message &message, char *buffer, int size) {
+    int length = 0;
+    int argIdx = 0;
+    const char *fmt = message.format;
+
+    while ((*fmt != '\0') && (length < size - 1)) {
+        if (*fmt != '%') {
+            buffer[length++] = *fmt++;
+            continue;
+        }
+        if (fmt[1] == '%') {
+            buffer[length++] = '%';
+            fmt += 2;
+            continue;
+        }
+
+        char spec[24];
+        int specLength = 0;
+        spec[specLength++] = *fmt++;
+        while ((*fmt != '\0') && (std::strchr("-+ #0123456789.", *fmt) != nullptr) &&
+               (specLength < 16)) {
+            spec[specLength++] = *fmt++;
+        }
+        while ((*fmt != '\0') && (std::strchr("hljztLq", *fmt) != nullptr)) {
+            fmt++;
+        }
+        char conversion = *fmt;
+        if (conversion == '\0') {
+            break;
+        }
+        fmt++;
+
+        if (argIdx >= message.argCount) {
+            append(buffer, size, length, "%s", "?");
+            continue;
+        }
+        ArgType type = message.types[argIdx];
+        uint64_t value = message.values[argIdx];
+        uint8_t bytes = message.sizes[argIdx];
+        argIdx++;
+
+        switch (conversion) {
+        case 'd':
+        case 'i':
+        case 'o':
+        case 'u':
+        case 'x':
+        case 'X':
+            spec[specLength++] = 'l';
+            spec[specLength++] = 'l';
+            spec[specLength++] = conversion;
+            spec[specLength] = '\0';
+            if ((conversion == 'd') || (conversion == 'i')) {
+                append(buffer, size, length, spec, toSigned(value, bytes));
+            } else {
+                append(buffer, size, length, spec, toUnsigned(value, bytes));
+            }
+            break;
+        case 'c':
+            spec[specLength++] = 'c';
+            spec[specLength] = '\0';
+            append(buffer, size, length, spec, static_cast<int>(value));
+            break;
+        case 's':
+            spec[specLength++] = 's';
+            spec[specLength] = '\0';
+            append(buffer, size, length, spec,
+                   (type == ArgType::STRING) ? &message.strings[value] : "?");
+            break;
+        case 'p':
+            append(buffer, size, length, "%p",
+                   reinterpret_cast<const void *>(static_cast<uintptr_t>(value)));
+            break;
+        case 'f':
+        case 'F':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A': {
+            double number;
+            if (type == ArgType::DOUBLE) {
+                std::memcpy(&number, &value, sizeof(number));
+            } else {
+                number = static_cast<double>(toSigned(value, bytes));
+            }
+            spec[specLength++] = conversion;
+            spec[specLength] = '\0';
+            append(buffer, size, length, spec, number);
+            break;
+        }
+        default:
+            append(buffer, size, length, "%s", "?");
+            break;
+        }
+    }
+    buffer[length] = '\0';
+}
+
+#endif
+
+} // namespace
+
+#if CONFIG_TINYFONT_DEFERRED_LOG
+
+auto Site::admit(uint32_t &suppressed) -> bool {
+    uint32_t now = milliseconds();
+    uint32_t start = windowStart_.load(std::memory_order_relaxed);
+    if ((now - start) >= RATE_WINDOW) {
+        if (windowStart_.compare_exchange_strong(start, now, std::memory_order_relaxed)) {
+            windowCount_.store(0, std::memory_order_relaxed);
+        }
+    }
+    if (windowCount_.fetch_add(1, std::memory_order_relaxed) >= RATE_LIMIT) {
+        suppressed_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    suppressed = suppressed_.exchange(0, std::memory_order_relaxed);
+    return true;
+}
+
+void setClock(Clock newClock) { clock.store(newClock, std::memory_order_release); }
+
+auto claim(uint32_t &index) -> Message & {
+    index = head.fetch_add(1, std::memory_order_relaxed);
+    Record &record = ring[index & (RING_SIZE - 1)];
+    record.sequence.store(WRITING, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    return record.message;
+}
+
+void commit(uint32_t index) {
+    ring[index & (RING_SIZE - 1)].sequence.store(index + 1, std::memory_order_release);
+}
+
+#endif
+
+void setSink(Sink newSink) { sink.store(newSink, std::memory_order_release); }
+
+void countUnknownCodePoint(char32_t codePoint) {
+    uint32_t key = static_cast<uint32_t>(codePoint) + 1;
+    if (countInSlot(key)) {
+        return;
+    }
+#if !CONFIG_TINYFONT_DEFERRED_LOG
+    // drain() may never be called: the counts are printed to free the slots.
+    if (!draining.test_and_set(std::memory_order_acquire)) {
+        summarizeUnknownCodePoints();
+        draining.clear(std::memory_order_release);
+        if (countInSlot(key)) {
+            return;
+        }
+    }
+#endif
+    otherUnknownCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+auto drain() -> uint32_t {
+    if (draining.test_and_set(std::memory_order_acquire)) {
+        return 0;
+    }
+    uint32_t emitted = 0;
+
+#if CONFIG_TINYFONT_DEFERRED_LOG
+    char buffer[MESSAGE_SIZE];
+    uint32_t lost = 0;
+    uint32_t last = head.load(std::memory_order_acquire);
+
+    if ((last - tail) > RING_SIZE) {
+        lost = last - tail - RING_SIZE;
+        tail = last - RING_SIZE;
+    }
+    while (tail != last) {
+        Record &record = ring[tail & (RING_SIZE - 1)];
+        uint32_t sequence = record.sequence.load(std::memory_order_acquire);
+        if ((sequence == WRITING) || (sequence == tail + 1 - RING_SIZE)) {
+            break; // Still being written: left for the next drain
+        }
+        if (sequence != tail + 1) {
+            lost++; // Overwritten by a newer message
+            tail++;
+            continue;
+        }
+        Message message = record.message;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (record.sequence.load(std::memory_order_relaxed) != sequence) {
+            lost++; // Overwritten while being copied
+            tail++;
+            continue;
+        }
+        tail++;
+
+        if (lost > 0) {
+            std::snprintf(buffer, MESSAGE_SIZE, "%" PRIu32 " log messages lost", lost);
+            emit(Level::WARNING, buffer);
+            emitted++;
+            lost = 0;
+        }
+        format(message, buffer, MESSAGE_SIZE);
+        if (message.suppressed > 0) {
+            int length = static_cast<int>(std::strlen(buffer));
+            append(buffer, MESSAGE_SIZE, length, " (%" PRIu32 " similar messages suppressed)",
+                   message.suppressed);
+        }
+        emit(message.level, buffer);
+        emitted++;
+    }
+    if (lost > 0) {
+        std::snprintf(buffer, MESSAGE_SIZE, "%" PRIu32 " log messages lost", lost);
+        emit(Level::WARNING, buffer);
+        emitted++;
+    }
+#endif
+
+    emitted += summarizeUnknownCodePoints();
+    draining.clear(std::memory_order_release);
+    return emitted;
+}
+
+} // namespace font_log
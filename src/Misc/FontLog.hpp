@@ -0,0 +1,177 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+
+// Deferred logging. With CONFIG_TINYFONT_DEFERRED_LOG, the LOGx macros of FontDefs.hpp do not
+// print: they record the format string and the binary value of the arguments in a lock-free
+// ring buffer, the application formatting and printing them with drain() outside of its
+// rendering. Each message site is limited to CONFIG_TINYFONT_LOG_RATE_LIMIT messages per
+// second, the next message of the site telling how many were suppressed. When the ring is
+// full, the oldest messages are dropped.
+//
+// Whatever the option, the unknown code points are counted once per code point (see
+// countUnknownCodePoint()) instead of being logged on each occurrence.
+
+#ifndef CONFIG_TINYFONT_DEFERRED_LOG
+#define CONFIG_TINYFONT_DEFERRED_LOG 0
+#endif
+#ifndef CONFIG_TINYFONT_LOG_RING_SIZE
+#define CONFIG_TINYFONT_LOG_RING_SIZE 32
+#endif
+#ifndef CONFIG_TINYFONT_LOG_RATE_LIMIT
+#define CONFIG_TINYFONT_LOG_RATE_LIMIT 10
+#endif
+
+namespace font_log {
+
+enum class Level : uint8_t { ERROR, WARNING, INFO, DEBUG };
+
+/// @brief Receives each message formatted by drain(), without its final new line.
+typedef void (*Sink)(Level level, const char *message);
+
+/// @brief Send the messages drained to **sink**, nullptr restoring the standard output.
+void setSink(Sink sink);
+
+/// @brief Format and print the messages recorded since the previous call, followed by the
+/// count of each unknown code point received. Only one thread drains at a time: a call made
+/// while another is draining returns 0.
+/// @return The number of messages printed.
+auto drain() -> uint32_t;
+
+/// @brief Count an unknown code point received by a driver, instead of logging each of its
+/// occurrences. Only the first occurrence of a code point between two drains is logged, and
+/// drain() prints how many times each code point was received.
+/// Without CONFIG_TINYFONT_DEFERRED_LOG, the counts are also printed, and their slots freed,
+/// when a code point finds them all in use.
+void countUnknownCodePoint(char32_t codePoint);
+
+#if CONFIG_TINYFONT_DEFERRED_LOG
+
+const constexpr uint32_t RING_SIZE = CONFIG_TINYFONT_LOG_RING_SIZE;
+const constexpr uint32_t RATE_LIMIT = CONFIG_TINYFONT_LOG_RATE_LIMIT;
+const constexpr uint32_t RATE_WINDOW = 1000; // In milliseconds
+const constexpr int MAX_ARGS = 8;
+const constexpr int STRING_BYTES = 48; // For the copies of all the string arguments of a message
+
+static_assert((RING_SIZE & (RING_SIZE - 1)) == 0, "The log ring size must be a power of two");
+
+enum class ArgType : uint8_t { SIGNED, UNSIGNED, DOUBLE, STRING, POINTER };
+
+struct Message {
+    const char *format; // A string literal: kept as is
+    Level level;
+    uint8_t argCount;
+    uint8_t stringBytes;
+    uint32_t suppressed; // Messages of the same site suppressed before this one
+    ArgType types[MAX_ARGS];
+    uint8_t sizes[MAX_ARGS]; // Bytes of the integer arguments
+    uint64_t values[MAX_ARGS]; // Integer, double or pointer bits, offset in strings
+    char strings[STRING_BYTES];
+};
+
+/// @brief Milliseconds of a monotonic clock.
+typedef uint32_t (*Clock)();
+
+/// @brief Measure the rate limits with **clock**, nullptr restoring the steady clock.
+void setClock(Clock clock);
+
+/// @brief Rate limiter of a message site, one per LOGx macro expansion.
+class Site {
+    std::atomic<uint32_t> windowStart_{0}; // In milliseconds
+    std::atomic<uint32_t> windowCount_{0};
+    std::atomic<uint32_t> suppressed_{0};
+
+public:
+    /// @brief Tell whether a message of the site can be recorded now. If so, **suppressed**
+    /// receives the count of the messages suppressed since the previous one.
+    auto admit(uint32_t &suppressed) -> bool;
+};
+
+// Claim the next slot of the ring, returning its message to fill and the index to commit.
+auto claim(uint32_t &index) -> Message &;
+void commit(uint32_t index);
+
+inline void encode(Message &message, const char *value) {
+    uint8_t idx = message.argCount++;
+    message.types[idx] = ArgType::STRING;
+    message.values[idx] = message.stringBytes;
+    if (value == nullptr) {
+        value = "(null)";
+    }
+    while ((message.stringBytes < STRING_BYTES - 1) && (*value != '\0')) {
+        message.strings[message.stringBytes++] = *value++;
+    }
+    message.strings[message.stringBytes] = '\0';
+    if (message.stringBytes < STRING_BYTES - 1) {
+        message.stringBytes++;
+    }
+}
+
+inline void encode(Message &message, char *value) {
+    encode(message, static_cast<const char *>(value));
+}
+
+template <typename T> inline void encode(Message &message, T value) {
+    if constexpr (std::is_enum_v<T>) {
+        encode(message, static_cast<std::underlying_type_t<T>>(value));
+    } else {
+        uint8_t idx = message.argCount++;
+        message.sizes[idx] = sizeof(T);
+        if constexpr (std::is_floating_point_v<T>) {
+            double number = value;
+            message.types[idx] = ArgType::DOUBLE;
+            std::memcpy(&message.values[idx], &number, sizeof(number));
+        } else if constexpr (std::is_pointer_v<T>) {
+            message.types[idx] = ArgType::POINTER;
+            message.values[idx] = reinterpret_cast<uintptr_t>(value);
+        } else if constexpr (std::is_signed_v<T>) {
+            message.types[idx] = ArgType::SIGNED;
+            message.values[idx] = static_cast<uint64_t>(static_cast<int64_t>(value));
+        } else {
+            message.types[idx] = ArgType::UNSIGNED;
+            message.values[idx] = static_cast<uint64_t>(value);
+        }
+    }
+}
+
+/// @brief Record a message of **site** in the ring buffer, if its rate allows.
+template <typename... Args>
+inline void record(Site &site, Level level, const char *format, Args... args) {
+    static_assert(sizeof...(Args) <= MAX_ARGS, "Too many arguments for a deferred log message");
+
+    uint32_t suppressed;
+    if (!site.admit(suppressed)) {
+        return;
+    }
+
+    uint32_t index;
+    Message &message = claim(index);
+    message.format = format;
+    message.level = level;
+    message.argCount = 0;
+    message.stringBytes = 0;
+    message.suppressed = suppressed;
+    (encode(message, args), ...);
+    commit(index);
+}
+
+#endif
+
+} // namespace font_log
+
+#if CONFIG_TINYFONT_DEFERRED_LOG
+// The printf call, never made, keeps the compiler's checks of the format and its arguments.
+#define FONT_LOG(level, format, ...)                                                               \
+    do {                                                                                           \
+        if (false) {                                                                               \
+            std::printf(format, ##__VA_ARGS__);                                                    \
+        }                                                                                          \
+        static font_log::Site fontLogSite;                                                         \
+        font_log::record(fontLogSite, level, format, ##__VA_ARGS__);                               \
+    } while (0)
+#endif
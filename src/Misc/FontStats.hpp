@@ -0,0 +1,190 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Hot path counters and timers of both drivers, for field builds to sample where the time
+// goes. They are only compiled with CONFIG_TINYFONT_STATS: otherwise the timers are empty
+// objects and count() an empty inline function, both removed by the compiler. The same
+// timers give the events of the host builds' tracer (see FontTrace.hpp).
+//
+// Timers are inclusive: the lig/kern time includes the optical kerning one, the cache misses
+// time the FreeType load and render ones. The counters are not atomic: with
+// CONFIG_TINYFONT_TTF_ASYNC_PREFETCH, the background prefetch only updates them under the
+// cache lock, the one the drawing and measuring methods take.
+
+#ifndef CONFIG_TINYFONT_STATS
+#define CONFIG_TINYFONT_STATS 0
+#endif
+#ifndef CONFIG_TINYFONT_TRACE
+#define CONFIG_TINYFONT_TRACE 0
+#endif
+
+#if CONFIG_TINYFONT_TRACE && defined(ESP_PLATFORM)
+#error "CONFIG_TINYFONT_TRACE is only available on the host builds"
+#endif
+
+#if CONFIG_TINYFONT_STATS
+#if defined(ESP_PLATFORM)
+#include <esp_cpu.h>
+#else
+#include <chrono>
+#endif
+#endif
+
+enum class StatId : uint8_t {
+    TRANSLATE,    // Code point to glyph code
+    LIG_KERN,     // Ligature and kerning program of a glyph pair
+    OPTICAL_KERN, // IBMF optical kerning computation, the already computed pairs excluded
+    RLE_DECODE,   // IBMF glyph decoding, straight into the canvas when drawing
+    GLYPH_LOAD,   // TTF glyph loading and outline scaling by FreeType
+    GLYPH_RENDER, // TTF glyph rasterization by FreeType
+    CACHE_HIT,    // TTF glyphs' cache hits, counted only
+    CACHE_MISS,   // TTF glyphs' cache misses, with the time to load the glyph
+    CACHE_EVICT,  // TTF glyphs' cache eviction passes
+    BLIT,         // TTF cached glyph bitmap copy to the canvas
+    DRAW,         // drawSingleLineOfText() calls
+    MEASURE,      // getTextSize() and getTextWidth() calls
+    COUNT
+};
+
+struct FontStats {
+    struct Entry {
+        uint32_t count; // Calls, or events for the ones counted only
+        uint64_t ticks; // Time spent: CPU cycles on ESP-IDF, nanoseconds elsewhere
+    };
+
+    std::array<Entry, static_cast<size_t>(StatId::COUNT)> entries{};
+
+    [[nodiscard]] inline auto operator[](StatId id) -> Entry & {
+        return entries[static_cast<size_t>(id)];
+    }
+    [[nodiscard]] inline auto operator[](StatId id) const -> const Entry & {
+        return entries[static_cast<size_t>(id)];
+    }
+
+    [[nodiscard]] static inline constexpr auto getName(StatId id) -> const char * {
+        switch (id) {
+        case StatId::TRANSLATE:
+            return "translate";
+        case StatId::LIG_KERN:
+            return "lig_kern";
+        case StatId::OPTICAL_KERN:
+            return "optical_kern";
+        case StatId::RLE_DECODE:
+            return "rle_decode";
+        case StatId::GLYPH_LOAD:
+            return "glyph_load";
+        case StatId::GLYPH_RENDER:
+            return "glyph_render";
+        case StatId::CACHE_HIT:
+            return "cache_hit";
+        case StatId::CACHE_MISS:
+            return "cache_miss";
+        case StatId::CACHE_EVICT:
+            return "cache_evict";
+        case StatId::BLIT:
+            return "blit";
+        case StatId::DRAW:
+            return "draw";
+        case StatId::MEASURE:
+            return "measure";
+        default:
+            return "?";
+        }
+    }
+};
+
+#if CONFIG_TINYFONT_TRACE
+namespace font_trace {
+void begin(StatId id, uint32_t arg1, uint32_t arg2);
+void begin(StatId id, const std::string &text);
+void end(StatId id);
+} // namespace font_trace
+#endif
+
+namespace font_stats {
+
+#if CONFIG_TINYFONT_STATS
+inline FontStats stats{};
+
+/// @brief Current time, in ticks. Differences are right across a wrap around of the counter.
+inline auto ticks() -> uint32_t {
+#if defined(ESP_PLATFORM)
+    return static_cast<uint32_t>(esp_cpu_get_cycle_count());
+#else
+    return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     std::chrono::steady_clock::now().time_since_epoch())
+                                     .count());
+#endif
+}
+
+/// @brief Count an event of the **id** entry.
+inline void count(StatId id) { stats[id].count++; }
+#else
+inline void count(StatId) {}
+#endif
+
+#if CONFIG_TINYFONT_STATS || CONFIG_TINYFONT_TRACE
+/// @brief Count a call of the enclosing scope and add its duration to the **id** entry.
+///
+/// The arguments, glyph codes or code points, only label the trace events.
+class ScopedTimer {
+    StatId id_;
+#if CONFIG_TINYFONT_STATS
+    uint32_t start_{ticks()};
+#endif
+
+public:
+    explicit ScopedTimer(StatId id, [[maybe_unused]] uint32_t arg1 = 0,
+                         [[maybe_unused]] uint32_t arg2 = 0)
+        : id_(id) {
+#if CONFIG_TINYFONT_TRACE
+        font_trace::begin(id, arg1, arg2);
+#endif
+    }
+    ScopedTimer(StatId id, [[maybe_unused]] const std::string &text) : id_(id) {
+#if CONFIG_TINYFONT_TRACE
+        font_trace::begin(id, text);
+#endif
+    }
+    ~ScopedTimer() {
+#if CONFIG_TINYFONT_STATS
+        stats[id_].count++;
+        stats[id_].ticks += static_cast<uint32_t>(ticks() - start_);
+#endif
+#if CONFIG_TINYFONT_TRACE
+        font_trace::end(id_);
+#endif
+    }
+
+    ScopedTimer(const ScopedTimer &) = delete;
+    auto operator=(const ScopedTimer &) -> ScopedTimer & = delete;
+};
+#else
+class ScopedTimer {
+public:
+    explicit ScopedTimer(StatId, uint32_t = 0, uint32_t = 0) {}
+    ScopedTimer(StatId, const std::string &) {}
+};
+#endif
+
+/// @brief A copy of the counters and timers, all zero without CONFIG_TINYFONT_STATS.
+[[nodiscard]] inline auto getStats() -> FontStats {
+#if CONFIG_TINYFONT_STATS
+    return stats;
+#else
+    return {};
+#endif
+}
+
+/// @brief Set all the counters and timers back to zero.
+inline void resetStats() {
+#if CONFIG_TINYFONT_STATS
+    stats = {};
+#endif
+}
+
+} // namespace font_stats
@@ -0,0 +1,223 @@
+#include "FontTrace.hpp"
+
+#if CONFIG_TINYFONT_TRACE
+
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+#include "../FontDefs.hpp"
+
+namespace font_trace {
+
+namespace {
+
+struct Event {
+    uint64_t time; // Nanoseconds from start()
+    uint32_t thread;
+    uint32_t arg1, arg2;
+    uint32_t text; // 1 + index of the event text in texts, 0 if none
+    StatId id;
+    char phase; // 'B'egin or 'E'nd
+};
+
+std::atomic<bool> recording{false};
+std::atomic<uint32_t> threadCount{0};
+std::mutex mutex;
+std::vector<Event> events;
+std::vector<std::string> texts;
+std::chrono::steady_clock::time_point origin;
+
+// The scopes of a thread are nested: a bit per nesting level tells whether the begin event
+// of the level has been recorded, so that its end event is only recorded with it.
+thread_local uint32_t level = 0;
+thread_local uint64_t recordedLevels = 0;
+thread_local uint32_t threadIndex = 0;
+
+const constexpr uint32_t MAX_LEVEL = 64;
+
+auto elapsed() -> uint64_t {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now() - origin)
+        .count();
+}
+
+auto threadId() -> uint32_t {
+    if (threadIndex == 0) {
+        threadIndex = ++threadCount;
+    }
+    return threadIndex;
+}
+
+// Open a nesting level. Returns true if its begin event is to be recorded.
+auto enter() -> bool {
+    bool recorded = recording && (level < MAX_LEVEL);
+    if (level < MAX_LEVEL) {
+        if (recorded) {
+            recordedLevels |= uint64_t(1) << level;
+        } else {
+            recordedLevels &= ~(uint64_t(1) << level);
+        }
+    }
+    level++;
+    return recorded;
+}
+
+void record(StatId id, char phase, uint32_t arg1, uint32_t arg2, const std::string *text) {
+    std::lock_guard<std::mutex> guard(mutex);
+    if ((phase == 'B') && (events.size() >= MAX_EVENTS)) {
+        recordedLevels &= ~(uint64_t(1) << (level - 1));
+        return;
+    }
+    uint32_t textIndex = 0;
+    if (text != nullptr) {
+        texts.push_back(*text);
+        textIndex = static_cast<uint32_t>(texts.size());
+    }
+    events.push_back({.time = elapsed(),
+                      .thread = threadId(),
+                      .arg1 = arg1,
+                      .arg2 = arg2,
+                      .text = textIndex,
+                      .id = id,
+                      .phase = phase});
+}
+
+auto getCategory(StatId id) -> const char * {
+    switch (id) {
+    case StatId::TRANSLATE:
+        return "shaping";
+    case StatId::LIG_KERN:
+    case StatId::OPTICAL_KERN:
+        return "kerning";
+    case StatId::RLE_DECODE:
+    case StatId::GLYPH_LOAD:
+    case StatId::GLYPH_RENDER:
+    case StatId::CACHE_MISS:
+        return "rasterization";
+    case StatId::BLIT:
+        return "blitting";
+    case StatId::DRAW:
+    case StatId::MEASURE:
+        return "text";
+    default:
+        return "cache";
+    }
+}
+
+void writeString(FILE *file, const std::string &text) {
+    std::fputc('"', file);
+    for (char chr : text) {
+        if ((chr == '"') || (chr == '\\')) {
+            std::fprintf(file, "\\%c", chr);
+        } else if (static_cast<uint8_t>(chr) < 0x20) {
+            std::fprintf(file, "\\u%04x", static_cast<unsigned>(chr));
+        } else {
+            std::fputc(chr, file);
+        }
+    }
+    std::fputc('"', file);
+}
+
+void writeArgs(FILE *file, const Event &event) {
+    switch (event.id) {
+    case StatId::TRANSLATE:
+        std::fprintf(file, ", \"args\": {\"code_point\": \"U+%04" PRIX32 "\"}", event.arg1);
+        break;
+    case StatId::LIG_KERN:
+    case StatId::OPTICAL_KERN:
+        std::fprintf(file, ", \"args\": {\"glyph1\": %" PRIu32 ", \"glyph2\": %" PRIu32 "}",
+                     event.arg1, event.arg2);
+        break;
+    case StatId::RLE_DECODE:
+    case StatId::GLYPH_LOAD:
+    case StatId::GLYPH_RENDER:
+    case StatId::CACHE_MISS:
+    case StatId::BLIT:
+        std::fprintf(file, ", \"args\": {\"glyph\": %" PRIu32 "}", event.arg1);
+        break;
+    default:
+        if (event.text != 0) {
+            std::fprintf(file, ", \"args\": {\"text\": ");
+            writeString(file, texts[event.text - 1]);
+            std::fputc('}', file);
+        }
+        break;
+    }
+}
+
+} // namespace
+
+void begin(StatId id, uint32_t arg1, uint32_t arg2) {
+    if (enter()) {
+        record(id, 'B', arg1, arg2, nullptr);
+    }
+}
+
+void begin(StatId id, const std::string &text) {
+    if (enter()) {
+        record(id, 'B', 0, 0, &text);
+    }
+}
+
+void end(StatId id) {
+    level--;
+    if ((level < MAX_LEVEL) && ((recordedLevels >> level) & 1) && recording) {
+        record(id, 'E', 0, 0, nullptr);
+    }
+}
+
+void start() {
+    std::lock_guard<std::mutex> guard(mutex);
+    events.clear();
+    texts.clear();
+    origin = std::chrono::steady_clock::now();
+    recording = true;
+}
+
+auto stop(const char *path) -> bool {
+    recording = false;
+    std::lock_guard<std::mutex> guard(mutex);
+
+    FILE *file = std::fopen(path, "w");
+    if (file == nullptr) {
+        LOGE("Unable to create trace file %s.", path);
+        return false;
+    }
+
+    std::fprintf(file, "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n");
+    for (std::size_t i = 0; i < events.size(); i++) {
+        const Event &event = events[i];
+        std::fprintf(file,
+                     "{\"name\": \"%s\", \"cat\": \"%s\", \"ph\": \"%c\", \"ts\": %" PRIu64
+                     ".%03" PRIu64 ", \"pid\": 1, \"tid\": %" PRIu32,
+                     FontStats::getName(event.id), getCategory(event.id), event.phase,
+                     event.time / 1000, event.time % 1000, event.thread);
+        if (event.phase == 'B') {
+            writeArgs(file, event);
+        }
+        std::fprintf(file, "}%s\n", (i + 1 < events.size()) ? "," : "");
+    }
+    std::fprintf(file, "]}\n");
+
+    if (std::fclose(file) != 0) {
+        LOGE("Unable to write trace file %s.", path);
+        return false;
+    }
+    LOGI("Trace of %zu events written to %s.", events.size(), path);
+    return true;
+}
+
+auto isRecording() -> bool { return recording; }
+
+auto getEventCount() -> std::size_t {
+    std::lock_guard<std::mutex> guard(mutex);
+    return events.size();
+}
+
+} // namespace font_trace
+
+#endif
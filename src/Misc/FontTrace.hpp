@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+
+#include "FontStats.hpp"
+
+// Rendering timeline of the host builds. With CONFIG_TINYFONT_TRACE, the hot path timers of
+// FontStats.hpp record begin and end events between start() and stop(), the latter writing
+// them in the Chrome trace event format: the file opens in chrome://tracing or Perfetto.
+//
+// The events are named after their StatId and labelled with their glyph codes, code point
+// or text: the pairs of an expensive optical kerning or the glyphs rendered on a cache miss
+// show as the spikes of their line. They are kept in memory until stop().
+
+#if CONFIG_TINYFONT_TRACE
+
+namespace font_trace {
+
+// Over this count, the events beginning are dropped, with their end.
+const constexpr std::size_t MAX_EVENTS = 1 << 20;
+
+/// @brief Discard the events recorded so far and record the next ones.
+void start();
+
+/// @brief Stop recording and write the events to the trace file **path**.
+/// @return false if the file cannot be written.
+auto stop(const char *path) -> bool;
+
+[[nodiscard]] auto isRecording() -> bool;
+
+/// @brief Number of begin and end events recorded since start().
+[[nodiscard]] auto getEventCount() -> std::size_t;
+
+} // namespace font_trace
+
+#endif
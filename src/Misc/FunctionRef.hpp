@@ -0,0 +1,30 @@
+#pragma once
+
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+// Non-owning reference to a callable, for the callbacks only called during the call they are
+// given to. Unlike std::function, it never allocates: the closures of the drawing and
+// measuring methods would otherwise be copied to the heap once over two pointers in size.
+
+template <typename Signature> class FunctionRef;
+
+template <typename Result, typename... Args> class FunctionRef<Result(Args...)> {
+    void *callable_;
+    Result (*invoke_)(void *callable, Args... args);
+
+public:
+    template <typename Callable,
+              typename = std::enable_if_t<!std::is_same_v<std::decay_t<Callable>, FunctionRef>>>
+    FunctionRef(Callable &&callable) noexcept
+        : callable_(const_cast<void *>(static_cast<const void *>(std::addressof(callable)))),
+          invoke_([](void *target, Args... args) -> Result {
+              return (*static_cast<std::remove_reference_t<Callable> *>(target))(
+                  std::forward<Args>(args)...);
+          }) {}
+
+    inline auto operator()(Args... args) const -> Result {
+        return invoke_(callable_, std::forward<Args>(args)...);
+    }
+};
@@ -0,0 +1,104 @@
+#include "MappedFile.hpp"
+
+#include <cstdio>
+
+#include "../FontDefs.hpp"
+#include "SpiramAllocator.hpp"
+
+#if TINYFONT_MAPPED_FILE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if TINYFONT_MAPPED_FILE_MMAP
+
+auto MappedFile::open(const char *path) -> bool {
+    close();
+
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0) {
+        LOGE("Unable to open file %s.", path);
+        return false;
+    }
+
+    struct stat info;
+    if ((fstat(fd, &info) != 0) || (info.st_size == 0)) {
+        LOGE("Unable to get the size of file %s, or it is empty.", path);
+        ::close(fd);
+        return false;
+    }
+
+    auto size = static_cast<std::size_t>(info.st_size);
+    void *data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // The mapping keeps its own reference to the file
+
+    if (data == MAP_FAILED) {
+        LOGE("Unable to map file %s.", path);
+        return false;
+    }
+
+    data_ = static_cast<uint8_t *>(data);
+    size_ = size;
+    return true;
+}
+
+void MappedFile::close() {
+    if (data_ != nullptr) {
+        munmap(data_, size_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+}
+
+#else
+
+auto MappedFile::open(const char *path) -> bool {
+    close();
+
+    FILE *file = fopen(path, "rb");
+    if (file == nullptr) {
+        LOGE("Unable to open file %s.", path);
+        return false;
+    }
+
+    long size = -1;
+    if (fseek(file, 0, SEEK_END) == 0) {
+        size = ftell(file);
+    }
+    if ((size <= 0) || (fseek(file, 0, SEEK_SET) != 0)) {
+        LOGE("Unable to get the size of file %s, or it is empty.", path);
+        fclose(file);
+        return false;
+    }
+
+    auto data = static_cast<uint8_t *>(fontMalloc(static_cast<std::size_t>(size)));
+    if (data == nullptr) {
+        LOGE("Unable to allocate %ld bytes for file %s.", size, path);
+        fclose(file);
+        return false;
+    }
+
+    if (fread(data, 1, static_cast<std::size_t>(size), file) != static_cast<std::size_t>(size)) {
+        LOGE("Unable to read file %s.", path);
+        fontFree(data);
+        fclose(file);
+        return false;
+    }
+    fclose(file);
+
+    data_ = data;
+    size_ = static_cast<std::size_t>(size);
+    return true;
+}
+
+void MappedFile::close() {
+    if (data_ != nullptr) {
+        fontFree(data_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+}
+
+#endif
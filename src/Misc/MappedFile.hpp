@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Read-only view on the content of a file.
+//
+// On POSIX hosts, the file is mapped in memory: pages are only read when touched and are
+// shared by all the processes mapping the same file. Elsewhere, as on ESP-IDF, the file is
+// read once into a block of the font heap (SPIRAM when CONFIG_TINYFONT_USE_SPIRAM is set).
+// In both cases the font drivers use the content in place, without another copy.
+
+#if (defined(__unix__) || defined(__APPLE__)) && !defined(ESP_PLATFORM)
+#define TINYFONT_MAPPED_FILE_MMAP 1
+#else
+#define TINYFONT_MAPPED_FILE_MMAP 0
+#endif
+
+class MappedFile {
+    uint8_t *data_{nullptr};
+    std::size_t size_{0};
+
+public:
+    MappedFile() = default;
+    explicit MappedFile(const char *path) { open(path); }
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile &) = delete;
+    auto operator=(const MappedFile &) -> MappedFile & = delete;
+
+    MappedFile(MappedFile &&other) noexcept : data_(other.data_), size_(other.size_) {
+        other.data_ = nullptr;
+        other.size_ = 0;
+    }
+
+    /// @brief Map the file at **path**, closing the one previously mapped, if any.
+    /// @return false if the file cannot be opened, is empty or cannot be mapped.
+    auto open(const char *path) -> bool;
+
+    void close();
+
+    [[nodiscard]] inline auto isOpen() const -> bool { return data_ != nullptr; }
+    [[nodiscard]] inline auto data() const -> uint8_t * { return data_; }
+    [[nodiscard]] inline auto size() const -> std::size_t { return size_; }
+};
@@ -1,10 +1,49 @@
 #pragma once
 
+#include <cstdint>
+#include <cstdlib>
 #include <memory>
 #include <unordered_map>
 
 #if CONFIG_TINYFONT_USE_SPIRAM
 #include <esp_heap_caps.h>
+#endif
+
+// Raw memory blocks for the font caches. They come from the SPIRAM heap when
+// CONFIG_TINYFONT_USE_SPIRAM is set, from the standard heap otherwise.
+//
+// With CONFIG_TINYFONT_COUNT_ALLOCATIONS, a test mode, the blocks allocated by the calling
+// thread are counted in fontAllocationCount, the tests counting the operator new calls
+// themselves.
+
+#ifndef CONFIG_TINYFONT_COUNT_ALLOCATIONS
+#define CONFIG_TINYFONT_COUNT_ALLOCATIONS 0
+#endif
+
+#if CONFIG_TINYFONT_COUNT_ALLOCATIONS
+inline thread_local uint32_t fontAllocationCount = 0;
+#endif
+
+inline auto fontMalloc(std::size_t size) -> void * {
+#if CONFIG_TINYFONT_COUNT_ALLOCATIONS
+    fontAllocationCount++;
+#endif
+#if CONFIG_TINYFONT_USE_SPIRAM
+    return heap_caps_malloc(size, MALLOC_CAP_SPIRAM);
+#else
+    return malloc(size);
+#endif
+}
+
+inline void fontFree(void *block) {
+#if CONFIG_TINYFONT_USE_SPIRAM
+    heap_caps_free(block);
+#else
+    free(block);
+#endif
+}
+
+#if CONFIG_TINYFONT_USE_SPIRAM
 
 template <typename T>
 struct FontSpiramAllocator {
@@ -19,6 +58,9 @@ struct FontSpiramAllocator {
         // Using a pointer type as T will otherwise raises a warning since a common bug is to use a
         // pointer type in sizeof incorrectly. But we really do want the size of the pointer. As of
         // this writing, there are a couple of `SpiramMap` that have `const char *` as their values.
+#if CONFIG_TINYFONT_COUNT_ALLOCATIONS
+        fontAllocationCount++;
+#endif
         // NOLINTNEXTLINE(bugprone-sizeof-expression)
         return reinterpret_cast<T *>(heap_caps_malloc(n * sizeof(T), MALLOC_CAP_SPIRAM));
     }
@@ -32,6 +74,15 @@ struct FontSpiramAllocator {
     }
 
     void deallocate(T *p, std::size_t n) { heap_caps_free(reinterpret_cast<void *>(p)); }
+
+    template <typename U>
+    auto operator==(const FontSpiramAllocator<U> &) const -> bool {
+        return true;
+    }
+    template <typename U>
+    auto operator!=(const FontSpiramAllocator<U> &) const -> bool {
+        return false;
+    }
 };
 
 #endif
@@ -0,0 +1,118 @@
+#if CONFIG_TINYFONT_TTF
+
+#include "TTFAtlas.hpp"
+
+auto TTFAtlas::place(Page &page, uint16_t width, uint16_t height, Location &loc) -> bool {
+
+    // Best fit: the lowest shelf with enough room left.
+    Shelf *best = nullptr;
+    for (auto &shelf : page.shelves) {
+        if ((shelf.height >= height) && ((page.pitch - shelf.used) >= width) &&
+            ((best == nullptr) || (shelf.height < best->height))) {
+            best = &shelf;
+        }
+    }
+
+    if (best == nullptr) {
+        uint16_t rowsLeft = page.rows - page.nextShelfY;
+        if ((rowsLeft < height) || (page.pitch < width)) {
+            return false;
+        }
+        // Shelf heights are rounded up a bit to let them receive similar bitmaps.
+        uint16_t shelfHeight = (height + 3) & ~3;
+        if (shelfHeight > rowsLeft) {
+            shelfHeight = rowsLeft;
+        }
+        page.shelves.push_back({.y = page.nextShelfY, .height = shelfHeight, .used = 0});
+        page.nextShelfY += shelfHeight;
+        best = &page.shelves.back();
+    }
+
+    loc.x = best->used;
+    loc.y = best->y;
+    best->used += width;
+    page.live++;
+
+    return true;
+}
+
+auto TTFAtlas::allocate(PixelResolution resolution, uint16_t width, uint16_t height,
+                        uint32_t budget, Location &loc) -> int32_t {
+
+    bool oversized = (width > PAGE_PITCH) || (height > PAGE_ROWS);
+
+    if (!oversized) {
+        for (uint16_t i = 0; i < pages_.size(); i++) {
+            Page &page = pages_[i];
+            if ((page.live > 0) && (page.resolution == resolution) &&
+                place(page, width, height, loc)) {
+                loc.page = i;
+                return 0;
+            }
+        }
+    }
+
+    // Row sizes are kept 32 bits aligned.
+    uint16_t pitch = oversized ? ((width + 3) & ~3) : PAGE_PITCH;
+    uint16_t rows = oversized ? height : PAGE_ROWS;
+    uint32_t size = static_cast<uint32_t>(pitch) * rows;
+
+    if (size > budget) {
+        return -1;
+    }
+    auto data = static_cast<MemoryPtr>(fontMalloc(size));
+    if (data == nullptr) {
+        return -1;
+    }
+
+    // The slot of a released page is reused before growing the pages list.
+    loc.page = NO_PAGE;
+    for (uint16_t i = 0; i < pages_.size(); i++) {
+        if (pages_[i].data == nullptr) {
+            loc.page = i;
+            break;
+        }
+    }
+    if (loc.page == NO_PAGE) {
+        loc.page = static_cast<uint16_t>(pages_.size());
+        pages_.emplace_back();
+    }
+
+    Page &page = pages_[loc.page];
+    page.data = data;
+    page.pitch = pitch;
+    page.rows = rows;
+    page.nextShelfY = 0;
+    page.live = 0;
+    page.resolution = resolution;
+    page.shelves.clear();
+    place(page, width, height, loc);
+
+    return static_cast<int32_t>(size);
+}
+
+auto TTFAtlas::release(uint16_t page) -> uint32_t {
+    Page &p = pages_[page];
+    if ((p.live > 0) && (--p.live == 0)) {
+        // Empty pages are returned to the heap, for their room to be given to the next
+        // page of any size.
+        uint32_t size = static_cast<uint32_t>(p.pitch) * p.rows;
+        fontFree(p.data);
+        p.data = nullptr;
+        p.pitch = 0;
+        p.rows = 0;
+        p.shelves.clear();
+        p.nextShelfY = 0;
+        return size;
+    }
+    return 0;
+}
+
+void TTFAtlas::clear() {
+    for (auto &page : pages_) {
+        fontFree(page.data);
+    }
+    pages_.clear();
+}
+
+#endif
@@ -0,0 +1,106 @@
+#pragma once
+
+#if CONFIG_TINYFONT_TTF
+
+#include <vector>
+
+#include "../FontDefs.hpp"
+#include "../Misc/SpiramAllocator.hpp"
+#include "TTFDefs.hpp"
+
+using namespace font_defs;
+
+/**
+ * @brief Atlas pages for the TTFCache glyph bitmaps.
+ *
+ * Bitmaps are packed in a few large pages of PAGE_PITCH bytes per row, using a shelf
+ * packer: each page is cut in horizontal shelves and a bitmap is put at the end of the
+ * lowest shelf it fits in, a new shelf being opened when none is found. A page only
+ * receives bitmaps of a single pixel resolution. As a shelf packer cannot reuse the
+ * space of a single bitmap, a page is returned to the heap as a whole when its last bitmap
+ * is released, its room in the budget going to the next page of any size.
+ *
+ * Bitmaps too large for a regular page get a dedicated page of their own size.
+ */
+class TTFAtlas {
+public:
+    static constexpr uint16_t PAGE_PITCH = 256;
+    static constexpr uint16_t PAGE_ROWS = 64;
+    static constexpr uint16_t NO_PAGE = 0xFFFF;
+
+    struct Location {
+        uint16_t page;
+        uint16_t x; // In bytes from the start of the row
+        uint16_t y;
+    };
+
+private:
+    struct Shelf {
+        uint16_t y;
+        uint16_t height;
+        uint16_t used;
+    };
+
+#if CONFIG_TINYFONT_USE_SPIRAM
+    template <typename T>
+    using AtlasVector = std::vector<T, FontSpiramAllocator<T>>;
+#else
+    template <typename T>
+    using AtlasVector = std::vector<T>;
+#endif
+
+    struct Page {
+        MemoryPtr data;
+        uint16_t pitch;
+        uint16_t rows;
+        uint16_t nextShelfY;
+        uint16_t live;
+        PixelResolution resolution;
+        AtlasVector<Shelf> shelves;
+    };
+
+    AtlasVector<Page> pages_;
+
+    auto place(Page &page, uint16_t width, uint16_t height, Location &loc) -> bool;
+
+public:
+    TTFAtlas() = default;
+    ~TTFAtlas() { clear(); }
+
+    TTFAtlas(const TTFAtlas &) = delete;
+    auto operator=(const TTFAtlas &) -> TTFAtlas & = delete;
+
+    /// @brief Reserve room for a bitmap
+    ///
+    /// @param resolution In. The pixel resolution of the bitmap.
+    /// @param width In. The bitmap width, in bytes.
+    /// @param height In. The bitmap height, in rows.
+    /// @param budget In. Number of bytes that can still be taken from the heap for a new page.
+    /// @param loc Out. Where the bitmap has been put.
+    /// @return The number of bytes taken from the heap (0 if an existing page was used), or
+    ///         -1 if there is no room left for the bitmap.
+    ///
+    auto allocate(PixelResolution resolution, uint16_t width, uint16_t height, uint32_t budget,
+                  Location &loc) -> int32_t;
+
+    /// @brief Release a bitmap. The page is freed when its last bitmap is released.
+    /// @return The number of bytes returned to the heap.
+    auto release(uint16_t page) -> uint32_t;
+
+    [[nodiscard]] inline auto getPixels(const Location &loc) const -> MemoryPtr {
+        const Page &page = pages_[loc.page];
+        return page.data + (loc.y * page.pitch) + loc.x;
+    }
+
+    [[nodiscard]] inline auto getPitch(uint16_t page) const -> uint16_t {
+        return pages_[page].pitch;
+    }
+
+    [[nodiscard]] inline auto getPageCount() const -> uint16_t {
+        return static_cast<uint16_t>(pages_.size());
+    }
+
+    void clear();
+};
+
+#endif
@@ -0,0 +1,198 @@
+#if CONFIG_TINYFONT_TTF
+
+#include "TTFBlockStream.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "../Misc/SpiramAllocator.hpp"
+
+const constexpr uint32_t NO_BLOCK = 0xFFFFFFFF;
+
+TTFBlockStream::~TTFBlockStream() {
+    close();
+    fontFree(blocks_);
+    fontFree(memory_);
+}
+
+auto TTFBlockStream::allocateBlocks() -> bool {
+    if (blocks_ == nullptr) {
+        if ((blockSize_ == 0) || (blockCount_ == 0)) {
+            LOGE("The stream block cache needs at least one block.");
+            return false;
+        }
+        blocks_ = static_cast<Block *>(fontMalloc(sizeof(Block) * blockCount_));
+        memory_ = static_cast<uint8_t *>(fontMalloc(blockSize_ * blockCount_));
+        if ((blocks_ == nullptr) || (memory_ == nullptr)) {
+            LOGE("Unable to allocate the stream block cache (%" PRIu32 " bytes).",
+                 blockSize_ * blockCount_);
+            fontFree(blocks_);
+            fontFree(memory_);
+            blocks_ = nullptr;
+            memory_ = nullptr;
+            return false;
+        }
+    }
+    for (uint32_t i = 0; i < blockCount_; i++) {
+        blocks_[i] = Block{memory_ + i * blockSize_, NO_BLOCK, 0, 0};
+    }
+    return true;
+}
+
+void TTFBlockStream::setSize(uint32_t size) {
+    stream_ = FT_StreamRec{};
+    stream_.size = size;
+    stream_.descriptor.pointer = this;
+    stream_.read = streamRead;
+    useTick_ = 0;
+    resetStats();
+}
+
+auto TTFBlockStream::open(const char *path) -> bool {
+    close();
+
+    file_ = fopen(path, "rb");
+    if (file_ == nullptr) {
+        LOGE("Unable to open font file %s.", path);
+        return false;
+    }
+
+    long size = -1;
+    if (fseek(file_, 0, SEEK_END) == 0) {
+        size = ftell(file_);
+    }
+    if ((size <= 0) || !allocateBlocks()) {
+        LOGE("Unable to stream font file %s.", path);
+        close();
+        return false;
+    }
+
+    setSize(static_cast<uint32_t>(size));
+    return true;
+}
+
+#if defined(ESP_PLATFORM)
+auto TTFBlockStream::open(const esp_partition_t *partition) -> bool {
+    close();
+
+    if ((partition == nullptr) || !allocateBlocks()) {
+        LOGE("Unable to stream the font partition.");
+        return false;
+    }
+
+    // The font is followed by the unused space of the partition, never read by FreeType.
+    partition_ = partition;
+    setSize(partition->size);
+    return true;
+}
+#endif
+
+void TTFBlockStream::close() {
+    if (file_ != nullptr) {
+        fclose(file_);
+        file_ = nullptr;
+    }
+#if defined(ESP_PLATFORM)
+    partition_ = nullptr;
+#endif
+    stream_ = FT_StreamRec{};
+}
+
+auto TTFBlockStream::readSource(uint32_t offset, uint8_t *buffer, uint32_t count) -> uint32_t {
+    uint32_t length = 0;
+
+    if (file_ != nullptr) {
+        if (fseek(file_, offset, SEEK_SET) == 0) {
+            length = fread(buffer, 1, count, file_);
+        }
+    }
+#if defined(ESP_PLATFORM)
+    else if (partition_ != nullptr) {
+        if (esp_partition_read(partition_, offset, buffer, count) == ESP_OK) {
+            length = count;
+        }
+    }
+#endif
+
+    if (length != count) {
+        LOGE("Unable to read %" PRIu32 " bytes of the font at offset %" PRIu32 ".", count, offset);
+    }
+    sourceBytes_ += length;
+    return length;
+}
+
+auto TTFBlockStream::getBlock(uint32_t index) -> const Block * {
+
+    // A few blocks: a linear search costs less than reading one of them again.
+    Block *victim = &blocks_[0];
+    for (uint32_t i = 0; i < blockCount_; i++) {
+        Block &block = blocks_[i];
+        if (block.index == index) {
+            hitCount_++;
+            block.lastUse = ++useTick_;
+            return &block;
+        }
+        if (block.lastUse < victim->lastUse) {
+            victim = &block;
+        }
+    }
+
+    missCount_++;
+
+    uint32_t offset = index * blockSize_;
+    uint32_t length = std::min(blockSize_, static_cast<uint32_t>(stream_.size) - offset);
+    victim->length = readSource(offset, victim->data, length);
+    if (victim->length == 0) {
+        victim->index = NO_BLOCK;
+        victim->lastUse = 0;
+        return nullptr;
+    }
+    victim->index = index;
+    victim->lastUse = ++useTick_;
+    return victim;
+}
+
+auto TTFBlockStream::read(uint32_t offset, uint8_t *buffer, uint32_t count) -> uint32_t {
+    if (!isOpen() || (offset >= stream_.size)) {
+        return 0;
+    }
+    count = std::min(count, static_cast<uint32_t>(stream_.size) - offset);
+
+    if (count > ((blockSize_ * blockCount_) >> 1)) {
+        directReadCount_++;
+        return readSource(offset, buffer, count);
+    }
+
+    uint32_t done = 0;
+    while (done < count) {
+        uint32_t position = offset + done;
+        const Block *block = getBlock(position / blockSize_);
+        uint32_t inBlock = position % blockSize_;
+        if ((block == nullptr) || (inBlock >= block->length)) {
+            break;
+        }
+        uint32_t length = std::min(count - done, block->length - inBlock);
+        memcpy(buffer + done, block->data + inBlock, length);
+        done += length;
+    }
+    return done;
+}
+
+auto TTFBlockStream::streamRead(FT_Stream stream, unsigned long offset, unsigned char *buffer,
+                                unsigned long count) -> unsigned long {
+    // A count of 0 is a seek, returning 0 on success.
+    if (count == 0) {
+        return (offset > stream->size) ? 1 : 0;
+    }
+    auto self = static_cast<TTFBlockStream *>(stream->descriptor.pointer);
+    return self->read(offset, buffer, count);
+}
+
+void TTFBlockStream::showStats() const {
+    LOGI("Font stream statistics: hits: %" PRIu32 ", misses: %" PRIu32 ", hit rate: %.1f%%"
+         ", direct reads: %" PRIu32 ", bytes read: %" PRIu32 " of %lu.",
+         hitCount_, missCount_, getHitRate() * 100.0F, directReadCount_, sourceBytes_,
+         stream_.size);
+}
+
+#endif
@@ -0,0 +1,116 @@
+#pragma once
+
+#if CONFIG_TINYFONT_TTF
+
+#include <cstdio>
+
+#include "../FontDefs.hpp"
+#include "TTFDefs.hpp"
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+#if defined(ESP_PLATFORM)
+#include <esp_partition.h>
+#endif
+
+/**
+ * @brief FreeType stream reading a font file, or a flash partition, through a block cache.
+ *
+ * FreeType only reads the tables and glyph records it needs. They are read by blocks of
+ * **blockSize** bytes, the **blockCount** most recently used blocks being kept in memory:
+ * the table directory, cmap and the glyph index stay cached while the glyph records of the
+ * rendered text come and go. A read spanning more than half of the cache is done straight
+ * from the source, without evicting the blocks in use.
+ */
+class TTFBlockStream {
+    struct Block {
+        uint8_t *data;
+        uint32_t index;
+        uint32_t length;
+        uint32_t lastUse;
+    };
+
+    FT_StreamRec stream_{};
+
+    FILE *file_{nullptr};
+#if defined(ESP_PLATFORM)
+    const esp_partition_t *partition_{nullptr};
+#endif
+
+    uint32_t blockSize_;
+    uint32_t blockCount_;
+    Block *blocks_{nullptr};
+    uint8_t *memory_{nullptr};
+
+    uint32_t hitCount_{0};
+    uint32_t missCount_{0};
+    uint32_t directReadCount_{0};
+    uint32_t sourceBytes_{0};
+    uint32_t useTick_{0};
+
+    static auto streamRead(FT_Stream stream, unsigned long offset, unsigned char *buffer,
+                           unsigned long count) -> unsigned long;
+
+    auto allocateBlocks() -> bool;
+    void setSize(uint32_t size);
+
+    // Read from the file or the partition, bypassing the blocks.
+    auto readSource(uint32_t offset, uint8_t *buffer, uint32_t count) -> uint32_t;
+
+    auto getBlock(uint32_t index) -> const Block *;
+
+public:
+    explicit TTFBlockStream(uint32_t blockSize = CONFIG_TINYFONT_TTF_STREAM_BLOCK_SIZE,
+                            uint32_t blockCount = CONFIG_TINYFONT_TTF_STREAM_BLOCK_COUNT)
+        : blockSize_(blockSize), blockCount_(blockCount) {}
+
+    ~TTFBlockStream();
+
+    TTFBlockStream(const TTFBlockStream &) = delete;
+    auto operator=(const TTFBlockStream &) -> TTFBlockStream & = delete;
+
+    /// @brief Read the font file at **path**.
+    auto open(const char *path) -> bool;
+
+#if defined(ESP_PLATFORM)
+    /// @brief Read the font stored from the start of a flash **partition**.
+    auto open(const esp_partition_t *partition) -> bool;
+#endif
+
+    /// @brief Close the source. The faces opened on the stream must be done before.
+    void close();
+
+    [[nodiscard]] inline auto isOpen() const -> bool { return stream_.size > 0; }
+
+    /// @brief The stream to give to FT_Open_Face(), the source staying owned by this object.
+    [[nodiscard]] inline auto getStream() -> FT_Stream { return &stream_; }
+    [[nodiscard]] inline auto getSize() const -> uint32_t {
+        return static_cast<uint32_t>(stream_.size);
+    }
+
+    /// @brief Read **count** bytes from **offset** through the cache.
+    /// @return The number of bytes read, less than **count** at the end of the source.
+    auto read(uint32_t offset, uint8_t *buffer, uint32_t count) -> uint32_t;
+
+    [[nodiscard]] inline auto getBlockSize() const -> uint32_t { return blockSize_; }
+    [[nodiscard]] inline auto getBlockCount() const -> uint32_t { return blockCount_; }
+    [[nodiscard]] inline auto getHitCount() const -> uint32_t { return hitCount_; }
+    [[nodiscard]] inline auto getMissCount() const -> uint32_t { return missCount_; }
+    [[nodiscard]] inline auto getDirectReadCount() const -> uint32_t { return directReadCount_; }
+
+    /// @brief Bytes read from the file or the partition since opened or the last resetStats().
+    [[nodiscard]] inline auto getSourceBytes() const -> uint32_t { return sourceBytes_; }
+
+    /// @brief Part of the block lookups served from memory, between 0 and 1.
+    [[nodiscard]] inline auto getHitRate() const -> float {
+        uint32_t lookups = hitCount_ + missCount_;
+        return (lookups == 0) ? 0.0F : static_cast<float>(hitCount_) / lookups;
+    }
+
+    inline void resetStats() { hitCount_ = missCount_ = directReadCount_ = sourceBytes_ = 0; }
+
+    void showStats() const;
+};
+
+#endif
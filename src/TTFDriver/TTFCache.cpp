@@ -2,51 +2,412 @@
 
 #include "TTFCache.hpp"
 
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#include "../Misc/FNVHash.hpp"
 #include "TTFFont.hpp"
 
-auto TTFCache::doGetGlyph(Font &font, font_defs::GlyphCode glyphCode, uint32_t key)
-    -> std::optional<const font_defs::Glyph *> {
+auto TTFCache::doGetGlyph(Font &font, font_defs::GlyphCode glyphCode, uint32_t key,
+                          PixelResolution resolution) -> std::optional<const font_defs::Glyph *> {
+    font_stats::ScopedTimer timer(StatId::CACHE_MISS, glyphCode);
+
+    font_defs::Glyph glyph;
+
+    if (!font.getGlyphForCache(glyphCode, glyph)) {
+        return std::nullopt;
+    }
+
+    // Each eviction pass releases the older half of the glyphs: passes are repeated until the
+    // glyph fits, only failing when it does not fit in the empty store.
+    TTFGlyphStore::Index idx = store_.insert(key, glyph, resolution);
+    while ((idx == TTFGlyphStore::NO_INDEX) && (store_.getRecordCount() > 0)) {
+        evict();
+        idx = store_.insert(key, glyph, resolution);
+    }
+    if (idx == TTFGlyphStore::NO_INDEX) {
+        LOGE("Unable to allocate memory for a glyph.");
+        return std::nullopt;
+    }
+
+    if (!glyphCache_.insert(key, idx)) {
+        LOGE("Unable to allocate memory for the glyphs' index.");
+        store_.release(idx);
+        return std::nullopt;
+    }
+    missCount_++;
+
+    TTFGlyphStore::Record &rec = store_.record(idx);
+    rec.lastUse = ++useTick_;
+    // showBitmap(rec.glyph.bitmap, false, resolution);
+    return &rec.glyph;
+}
+
+auto TTFCache::doGetMeasure(Font &font, GlyphCode glyphCode, uint32_t key)
+    -> std::optional<Measure> {
+
+    Measure measure;
+    if (!font.getMeasureForCache(glyphCode, measure)) {
+        return std::nullopt;
+    }
+    measureMissCount_++;
+
+    if (measureCache_.size() >= MAX_MEASURE_COUNT) {
+        measureCache_.clear();
+    }
+    if (!measureCache_.insert(key, measure)) {
+        LOGW("Unable to allocate memory for the glyphs' metrics.");
+    }
+    return measure;
+}
+
+void TTFCache::evict() {
+    font_stats::ScopedTimer timer(StatId::CACHE_EVICT);
+
+    uint32_t oldest = useTick_;
+    store_.forEach([&oldest](TTFGlyphStore::Index, const TTFGlyphStore::Record &rec) {
+        if (rec.lastUse < oldest) {
+            oldest = rec.lastUse;
+        }
+    });
+
+    // Everything used before the middle of the oldest-to-newest span is released.
+    uint32_t limit = oldest + ((useTick_ - oldest) >> 1) + 1;
+
+#if CONFIG_TINYFONT_TTF_CACHE_ATLAS
+    // An atlas page only gets reusable once all its bitmaps are gone: the whole page whose
+    // most recent use is the oldest is released, with the old records without bitmap.
+    std::vector<uint32_t> pageLastUse(store_.getAtlas().getPageCount(), 0);
+    store_.forEach([&pageLastUse](TTFGlyphStore::Index, const TTFGlyphStore::Record &rec) {
+        if ((rec.glyph.bitmap.pixels != nullptr) &&
+            (rec.lastUse > pageLastUse[rec.location.page])) {
+            pageLastUse[rec.location.page] = rec.lastUse;
+        }
+    });
 
-#if CONFIG_TINYFONT_USE_SPIRAM
-    FontSpiramAllocator<font_defs::Glyph> allocator;
-    std::shared_ptr<font_defs::Glyph> glyph = allocator.allocateShared();
+    uint16_t victim = TTFAtlas::NO_PAGE;
+    for (uint16_t page = 0; page < pageLastUse.size(); page++) {
+        if ((pageLastUse[page] != 0) &&
+            ((victim == TTFAtlas::NO_PAGE) || (pageLastUse[page] < pageLastUse[victim]))) {
+            victim = page;
+        }
+    }
+
+    store_.forEach(
+        [this, limit, victim](TTFGlyphStore::Index idx, const TTFGlyphStore::Record &rec) {
+            bool hasBitmap = rec.glyph.bitmap.pixels != nullptr;
+            if ((hasBitmap && (rec.location.page == victim)) ||
+                (!hasBitmap && (rec.lastUse < limit))) {
+                glyphCache_.erase(rec.key);
+                store_.release(idx);
+                evictCount_++;
+            }
+        });
 #else
-    auto glyph = std::make_shared<font_defs::Glyph>();
+    store_.forEach([this, limit](TTFGlyphStore::Index idx, const TTFGlyphStore::Record &rec) {
+        if (rec.lastUse < limit) {
+            glyphCache_.erase(rec.key);
+            store_.release(idx);
+            evictCount_++;
+        }
+    });
 #endif
 
-    if (glyph == nullptr) {
-        clear();
+    store_.compact();
+}
+
+auto TTFCache::prefetchGlyph(Font &font, char32_t codePoint) -> bool {
+    [[maybe_unused]] auto guard = lock();
+
+    GlyphCode glyphCode = font.translate(codePoint);
+    if ((glyphCode == SPACE_CODE) || (glyphCode == NO_GLYPH_CODE)) {
+        return false;
+    }
+
+    uint32_t missCount = missCount_;
+    font.getCachedGlyph(glyphCode);
+    return missCount_ != missCount;
+}
+
+auto TTFCache::prefetch(Font &font, const std::string &text) -> uint32_t {
+    uint32_t count = 0;
 
-        if (glyph == nullptr) {
-            LOGE("Unable to allocate memory for a glyph.");
+    if (font.isInitialized()) {
+        if (&font.getFontData()->cache != this) {
+            LOGE("Prefetch with a font using another cache.");
+            return 0;
+        }
+
+        UTF8Iterator iter(text);
+        while (iter != text.end()) {
+#if CONFIG_TINYFONT_TTF_ASYNC_PREFETCH
+            if (cancelPrefetch_) {
+                break;
+            }
+#endif
+            if (prefetchGlyph(font, *iter++)) {
+                count++;
+            }
         }
     }
 
-    if (font.getGlyphForCache(glyphCode, *glyph)) {
-        glyphCache_.emplace(key, glyph);
-        missCount_++;
-        // showBitmap(glyph->bitmap, false, font.getFontPixelResolution());
-        return glyph.get();
+    return count;
+}
+
+auto TTFCache::prefetch(Font &font, char32_t first, char32_t last) -> uint32_t {
+    uint32_t count = 0;
+
+    if (font.isInitialized()) {
+        if (&font.getFontData()->cache != this) {
+            LOGE("Prefetch with a font using another cache.");
+            return 0;
+        }
+
+        for (char32_t codePoint = first; codePoint <= last; codePoint++) {
+            if (prefetchGlyph(font, codePoint)) {
+                count++;
+            }
+        }
     }
 
-    return std::nullopt;
+    return count;
 }
 
-void TTFCache::clear() {
-    for (auto &entry : glyphCache_) {
-        if (entry.second->bitmap.pixels != nullptr) {
-            free(entry.second->bitmap.pixels);
-            entry.second->bitmap.pixels = nullptr;
+#if CONFIG_TINYFONT_TTF_ASYNC_PREFETCH
+void TTFCache::prefetchAsync(Font &font, std::string text, PrefetchDoneHandler done) {
+    waitPrefetch();
+    cancelPrefetch_ = false;
+    worker_ = std::thread([this, &font, text = std::move(text), done = std::move(done)]() {
+        uint32_t count = prefetch(font, text);
+        if (done) {
+            done(count);
+        }
+    });
+}
+
+void TTFCache::waitPrefetch() {
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+#endif
+
+auto TTFCache::saveSnapshot(const char *path, uint32_t fontHash, bool unhinted) -> bool {
+    [[maybe_unused]] auto guard = lock();
+
+    FILE *file = fopen(path, "wb");
+    if (file == nullptr) {
+        LOGE("Unable to create the glyphs' cache snapshot %s.", path);
+        return false;
+    }
+
+    // Most recently used glyphs first
+    std::vector<TTFGlyphStore::Index> indexes;
+    indexes.reserve(store_.getRecordCount());
+    store_.forEach([&indexes](TTFGlyphStore::Index idx, const TTFGlyphStore::Record &) {
+        indexes.push_back(idx);
+    });
+    std::sort(indexes.begin(), indexes.end(),
+              [this](TTFGlyphStore::Index a, TTFGlyphStore::Index b) {
+        return store_.record(a).lastUse > store_.record(b).lastUse;
+    });
+
+    SnapshotHeader header{};
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.dpi = SCREEN_RES_PER_INCH;
+    header.fontHash = fontHash;
+    header.glyphCount = static_cast<uint32_t>(indexes.size());
+    header.checksum = FNV_OFFSET_BASIS;
+    header.unhinted = unhinted ? 1 : 0;
+    header.monoRendering = static_cast<uint8_t>(DEFAULT_MONO_RENDERING);
+
+    // The header is written again once the payload size and checksum are known.
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+
+    for (auto idx : indexes) {
+        if (!ok) {
+            break;
         }
+        const TTFGlyphStore::Record &rec = store_.record(idx);
+        const Glyph &glyph = rec.glyph;
+        auto resolution = static_cast<PixelResolution>(rec.key >> 28);
+
+        // Cleared first so that no uninitialized padding gets into the file and its checksum.
+        SnapshotGlyph entry;
+        memset(&entry, 0, sizeof(entry));
+        entry.key = rec.key;
+        entry.xoff = glyph.metrics.xoff;
+        entry.yoff = glyph.metrics.yoff;
+        entry.descent = glyph.metrics.descent;
+        entry.advance = glyph.metrics.advance;
+        entry.lineHeight = glyph.metrics.lineHeight;
+        entry.width = static_cast<uint16_t>(glyph.bitmap.dim.width);
+        entry.height = static_cast<uint16_t>(glyph.bitmap.dim.height);
+        if (glyph.bitmap.pixels == nullptr) {
+            entry.width = entry.height = 0;
+        } else {
+            entry.rowBytes = glyphRowBytes(entry.width, resolution);
+        }
+
+        ok = fwrite(&entry, sizeof(entry), 1, file) == 1;
+        header.checksum = fnv1a(&entry, sizeof(entry), header.checksum);
+        header.payloadSize += sizeof(entry);
+
+        MemoryPtr row = glyph.bitmap.pixels;
+        for (int y = 0; ok && (y < entry.height); y++, row += glyph.bitmap.pitch) {
+            ok = fwrite(row, entry.rowBytes, 1, file) == 1;
+            header.checksum = fnv1a(row, entry.rowBytes, header.checksum);
+            header.payloadSize += entry.rowBytes;
+        }
+    }
+
+    if (ok) {
+        ok = (fseek(file, 0, SEEK_SET) == 0) && (fwrite(&header, sizeof(header), 1, file) == 1);
+    }
+    if (fclose(file) != 0) {
+        ok = false;
+    }
+
+    if (!ok) {
+        LOGE("Unable to write the glyphs' cache snapshot %s.", path);
+        remove(path);
+        return false;
+    }
+
+    LOGI("Glyphs' cache snapshot saved: %" PRIu32 " glyphs, %" PRIu32 " bytes.",
+         header.glyphCount, header.payloadSize);
+    return true;
+}
+
+auto TTFCache::loadSnapshot(const char *path, uint32_t fontHash, bool unhinted) -> bool {
+    [[maybe_unused]] auto guard = lock();
+
+    FILE *file = fopen(path, "rb");
+    if (file == nullptr) {
+        return false;
+    }
+
+    SnapshotHeader header;
+    if ((fread(&header, sizeof(header), 1, file) != 1) ||
+        (memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0) ||
+        (header.version != SNAPSHOT_VERSION)) {
+        LOGW("Glyphs' cache snapshot %s not recognized.", path);
+        fclose(file);
+        return false;
+    }
+    if ((header.fontHash != fontHash) || (header.dpi != SCREEN_RES_PER_INCH)) {
+        LOGW("Glyphs' cache snapshot %s is for another font.", path);
+        fclose(file);
+        return false;
+    }
+    if ((header.unhinted != (unhinted ? 1 : 0)) ||
+        (header.monoRendering != static_cast<uint8_t>(DEFAULT_MONO_RENDERING))) {
+        LOGW("Glyphs' cache snapshot %s is for another rendering mode.", path);
+        fclose(file);
+        return false;
+    }
+
+    auto payload = static_cast<MemoryPtr>(fontMalloc(header.payloadSize));
+    if (payload == nullptr) {
+        LOGE("Unable to allocate memory to load the glyphs' cache snapshot.");
+        fclose(file);
+        return false;
     }
-    glyphCache_.clear();
-    hitCount_ = missCount_ = 0;
+    bool ok = (header.payloadSize == 0) || (fread(payload, header.payloadSize, 1, file) == 1);
+    fclose(file);
+
+    if (!ok || (fnv1a(payload, header.payloadSize) != header.checksum)) {
+        LOGW("Glyphs' cache snapshot %s is corrupted.", path);
+        fontFree(payload);
+        return false;
+    }
+
+    // The entries are first all validated, as the payload content is not trusted more than
+    // its checksum is.
+    uint32_t pos = 0;
+    for (uint32_t i = 0; ok && (i < header.glyphCount); i++) {
+        SnapshotGlyph entry;
+        ok = (header.payloadSize - pos) >= sizeof(entry);
+        if (ok) {
+            memcpy(&entry, payload + pos, sizeof(entry));
+            pos += sizeof(entry);
+            auto resolution = static_cast<PixelResolution>(entry.key >> 28);
+            uint32_t bitmapSize = static_cast<uint32_t>(entry.rowBytes) * entry.height;
+            ok = (entry.key != FlatHashMap<TTFGlyphStore::Index>::EMPTY_KEY) &&
+                 (resolution <= PixelResolution::FOUR_BITS) && (entry.width <= INT16_MAX) &&
+                 (entry.height <= INT16_MAX) &&
+                 (entry.rowBytes >= glyphRowBytes(entry.width, resolution)) &&
+                 ((header.payloadSize - pos) >= bitmapSize);
+            pos += bitmapSize;
+        }
+    }
+    if (!ok || (pos != header.payloadSize)) {
+        LOGW("Glyphs' cache snapshot %s is inconsistent.", path);
+        fontFree(payload);
+        return false;
+    }
+
+    uint32_t count = 0;
+    useTick_ += header.glyphCount;
+    pos = 0;
+    for (uint32_t i = 0; i < header.glyphCount; i++) {
+        SnapshotGlyph entry;
+        memcpy(&entry, payload + pos, sizeof(entry));
+        pos += sizeof(entry);
+        MemoryPtr pixels = payload + pos;
+        pos += static_cast<uint32_t>(entry.rowBytes) * entry.height;
+
+        if (glyphCache_.find(entry.key) != nullptr) {
+            continue;
+        }
+
+        Glyph glyph;
+        glyph.clear();
+        glyph.metrics = {.xoff = entry.xoff,
+                         .yoff = entry.yoff,
+                         .descent = entry.descent,
+                         .advance = entry.advance,
+                         .lineHeight = entry.lineHeight};
+        glyph.bitmap.dim = Dim(entry.width, entry.height);
+        glyph.bitmap.pitch = entry.rowBytes;
+        glyph.bitmap.pixels = (entry.height > 0) ? pixels : nullptr;
+
+        auto resolution = static_cast<PixelResolution>(entry.key >> 28);
+        TTFGlyphStore::Index idx = store_.insert(entry.key, glyph, resolution);
+        if (idx == TTFGlyphStore::NO_INDEX) {
+            break; // The cache budget is reached
+        }
+        if (!glyphCache_.insert(entry.key, idx)) {
+            store_.release(idx);
+            break;
+        }
+        // Keep the file order as the recency order.
+        store_.record(idx).lastUse = useTick_ - i;
+        count++;
+    }
+
+    fontFree(payload);
+    LOGI("Glyphs' cache snapshot loaded: %" PRIu32 " glyphs.", count);
+    return true;
+}
+
+void TTFCache::clear() {
+    glyphCache_.reset();
+    measureCache_.reset();
+    store_.clear();
+    hitCount_ = missCount_ = evictCount_ = 0;
+    measureHitCount_ = measureMissCount_ = 0;
     LOGI("Glyphs' cache cleared.");
 }
 
 void TTFCache::showStats() const {
-    LOGI("Glyphs' cache statistics: hits: %" PRIu32 ", misses: %" PRIu32 ".", hitCount_,
-         missCount_);
+    LOGI("Glyphs' cache statistics: hits: %" PRIu32 ", misses: %" PRIu32 ", evictions: %" PRIu32
+         ", memory: %" PRIu32 " bytes.",
+         hitCount_, missCount_, evictCount_, store_.getAllocatedBytes());
+    LOGI("Glyphs' metrics statistics: hits: %" PRIu32 ", misses: %" PRIu32 ".", measureHitCount_,
+         measureMissCount_);
 }
 
 void TTFCache::showBitmap(const Bitmap &bitmap, bool inverted,
@@ -79,6 +440,24 @@ void TTFCache::showBitmap(const Bitmap &bitmap, bool inverted,
             std::cout << '|';
             std::cout << std::endl << std::flush;
         }
+    } else if (isPackedResolution(pixelResolution)) {
+        const int bits = bitsPerPixel(pixelResolution);
+        const int max = (1 << bits) - 1;
+        uint32_t rowSize = bitmap.pitch;
+        uint32_t height = static_cast<uint32_t>(bitmap.dim.height);
+        for (row = 0, rowPtr = bitmap.pixels; row < height; row++, rowPtr += rowSize) {
+            std::cout << "   |";
+            for (col = 0; col < maxWidth; col++) {
+                int bit = col * bits;
+                int level = (rowPtr[bit >> 3] >> (8 - bits - (bit & 7))) & max;
+                if (inverted) {
+                    level = max - level;
+                }
+                std::cout << " .,:ilwW"[level * 7 / max];
+            }
+            std::cout << '|';
+            std::cout << std::endl << std::flush;
+        }
     } else {
         uint32_t rowSize = bitmap.pitch;
         for (row = 0, rowPtr = bitmap.pixels; row < bitmap.dim.height; row++, rowPtr += rowSize) {
@@ -4,56 +4,244 @@
 
 #include <memory>
 #include <optional>
+#include <string>
+
+#if CONFIG_TINYFONT_TTF_ASYNC_PREFETCH
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <thread>
+#endif
 
 #include "../FontDefs.hpp"
-#include "../Misc/SpiramAllocator.hpp"
+#include "../Misc/FlatHashMap.hpp"
 #include "TTFDefs.hpp"
+#include "TTFGlyphStore.hpp"
 
 using namespace font_defs;
 
 class Font;
 
 class TTFCache {
+public:
+    /// Glyph information required to measure text, obtained without rendering the glyph.
+    struct Measure {
+        GlyphMetrics metrics;
+        uint16_t width; // Width of the glyph bitmap, in pixels
+    };
+
 private:
-#if CONFIG_TINYFONT_USE_SPIRAM
-    template <typename K, typename V>
-    using SpiramMap = std::unordered_map<K, V, std::hash<K>, std::equal_to<K>,
-                                         FontSpiramAllocator<std::pair<const K, V>>>;
+    // Over this count of measures, the metrics cache is emptied before receiving a new one.
+    static constexpr uint32_t MAX_MEASURE_COUNT = 4096;
+
+    FlatHashMap<TTFGlyphStore::Index> glyphCache_;
+    FlatHashMap<Measure> measureCache_;
+    TTFGlyphStore store_{CONFIG_TINYFONT_TTF_CACHE_SIZE * 1024};
 
-    SpiramMap<uint32_t, std::shared_ptr<Glyph>> glyphCache_;
-#else
-    std::unordered_map<uint32_t, std::shared_ptr<Glyph>> glyphCache_;
-#endif
     uint32_t hitCount_ = 0;
     uint32_t missCount_ = 0;
+    uint32_t evictCount_ = 0;
+    uint32_t measureHitCount_ = 0;
+    uint32_t measureMissCount_ = 0;
+    uint32_t useTick_ = 0;
+
+#if CONFIG_TINYFONT_TTF_ASYNC_PREFETCH
+    std::recursive_mutex mutex_;
+    std::thread worker_;
+    std::atomic<bool> cancelPrefetch_{false};
+#endif
 
-    auto doGetGlyph(Font &font, GlyphCode glyphCode, uint32_t key) -> std::optional<const Glyph *>;
+    // Snapshot file layout: a SnapshotHeader followed by glyphCount entries, each one being a
+    // SnapshotGlyph immediately followed by its rowBytes * height bitmap bytes. Values are
+    // in the byte order of the device writing the file.
+    static constexpr char SNAPSHOT_MAGIC[4] = {'T', 'F', 'G', 'C'};
+    static constexpr uint16_t SNAPSHOT_VERSION = 2;
+
+    struct SnapshotHeader {
+        char magic[4];
+        uint16_t version;
+        uint16_t dpi;
+        uint32_t fontHash;
+        uint32_t glyphCount;
+        uint32_t payloadSize;
+        uint32_t checksum; // FNV-1a of the payload
+        uint8_t unhinted;  // Glyphs rendered from the outlines' cache, without hinting
+        uint8_t monoRendering;
+        uint16_t reserved;
+    };
+
+    struct SnapshotGlyph {
+        uint32_t key;
+        int16_t xoff, yoff;
+        int16_t descent;
+        FIX16 advance;
+        int16_t lineHeight;
+        uint16_t width, height;
+        uint16_t rowBytes;
+    };
+
+    auto prefetchGlyph(Font &font, char32_t codePoint) -> bool;
+
+    auto doGetGlyph(Font &font, GlyphCode glyphCode, uint32_t key, PixelResolution resolution)
+        -> std::optional<const Glyph *>;
+
+    auto doGetMeasure(Font &font, GlyphCode glyphCode, uint32_t key) -> std::optional<Measure>;
+
+    // Release the least recently used half of the glyphs and compact the store.
+    void evict();
 
 public:
     TTFCache() = default;
 
     ~TTFCache() {
+#if CONFIG_TINYFONT_TTF_ASYNC_PREFETCH
+        cancelPrefetch_ = true;
+        waitPrefetch();
+#endif
         showStats();
         clear();
     }
 
-    inline auto getGlyph(Font &font, GlyphCode glyphCode, int16_t charSize)
-        -> std::optional<const Glyph *> {
+#if CONFIG_TINYFONT_TTF_ASYNC_PREFETCH
+    typedef std::unique_lock<std::recursive_mutex> Lock;
+    typedef std::function<void(uint32_t)> PrefetchDoneHandler;
+
+    /// @brief Lock the cache and the fonts using it against a background prefetch.
+    [[nodiscard]] inline auto lock() -> Lock { return Lock(mutex_); }
+#else
+    struct Lock {};
+
+    [[nodiscard]] inline auto lock() -> Lock { return {}; }
+#endif
+
+    /// @brief Build the key of a glyph in the cache
+    ///
+    /// Glyphs of all sizes and pixel resolutions coexist in the cache:
+    ///
+    ///   - bits 0-15:  the glyph code, 0x8000 being set for the private face glyphs
+    ///   - bits 16-27: the character size, in points
+    ///   - bits 28-31: the font pixel resolution
+    ///
+    [[nodiscard]] static inline auto makeKey(GlyphCode glyphCode, uint16_t ptSize,
+                                             PixelResolution resolution) -> uint32_t {
+        return (static_cast<uint32_t>(resolution) << 28) |
+               (static_cast<uint32_t>(ptSize & 0x0FFF) << 16) | glyphCode;
+    }
+
+    inline auto getGlyph(Font &font, GlyphCode glyphCode, uint16_t ptSize,
+                         PixelResolution resolution) -> std::optional<const Glyph *> {
 
-        auto key = static_cast<uint32_t>(static_cast<uint32_t>(charSize << 16) | glyphCode);
-        auto it = glyphCache_.find(key);
-        if (it != glyphCache_.end()) {
-            // log_d("hit(%" PRIu16 ") -> %p!", glyphCode, (void *)it->second);
+        uint32_t key = makeKey(glyphCode, ptSize, resolution);
+        TTFGlyphStore::Index *idx = glyphCache_.find(key);
+        if (idx != nullptr) {
+            // log_d("hit(%" PRIu16 ") -> %p!", glyphCode, (void *)idx);
             hitCount_++;
-            return it->second.get();
+            font_stats::count(StatId::CACHE_HIT);
+            TTFGlyphStore::Record &rec = store_.record(*idx);
+            rec.lastUse = ++useTick_;
+            return &rec.glyph;
+        }
+
+        return doGetGlyph(font, glyphCode, key, resolution);
+    }
+
+    /// @brief Retrieve the metrics of a glyph, without rendering it
+    ///
+    /// A glyph already present in the cache gives its metrics. Otherwise they are kept in a
+    /// separate metrics cache, filled from the glyph outline: text measurement does not
+    /// cost a bitmap rendering and allocation for glyphs that are never drawn.
+    ///
+    inline auto getMeasure(Font &font, GlyphCode glyphCode, uint16_t ptSize,
+                           PixelResolution resolution) -> std::optional<Measure> {
+
+        uint32_t key = makeKey(glyphCode, ptSize, resolution);
+        if (TTFGlyphStore::Index *idx = glyphCache_.find(key); idx != nullptr) {
+            measureHitCount_++;
+            const Glyph &glyph = store_.record(*idx).glyph;
+            return Measure{.metrics = glyph.metrics,
+                           .width = static_cast<uint16_t>(glyph.bitmap.dim.width)};
+        }
+        if (Measure *measure = measureCache_.find(key); measure != nullptr) {
+            measureHitCount_++;
+            return *measure;
         }
 
-        return doGetGlyph(font, glyphCode, key);
+        return doGetMeasure(font, glyphCode, key);
     }
 
+    /// @brief Load the glyphs of **text** ahead of time
+    ///
+    /// The glyphs are rendered at the current size and font pixel resolution of **font**,
+    /// that must be using this cache. To warm up other sizes, prefetch with a Font of
+    /// each size.
+    ///
+    /// @param font In. The font to get the glyphs from.
+    /// @param text In. UTF8 string of characters to load.
+    /// @return The number of glyphs that were not yet in the cache.
+    ///
+    auto prefetch(Font &font, const std::string &text) -> uint32_t;
+
+    /// @brief Load the glyphs of the code points **first** to **last** (inclusive) ahead of time
+    auto prefetch(Font &font, char32_t first, char32_t last) -> uint32_t;
+
+#if CONFIG_TINYFONT_TTF_ASYNC_PREFETCH
+    /// @brief Load the glyphs of **text** on a background worker thread
+    ///
+    /// A prefetch still running is completed first. The glyphs are loaded one at a time
+    /// under the cache lock, the font drawing and measuring methods taking the same lock.
+    /// **font** must not be destroyed before **done** has been called.
+    ///
+    /// @param font In. The font to get the glyphs from.
+    /// @param text In. UTF8 string of characters to load.
+    /// @param done Call. Optional, called from the worker with the number of glyphs loaded.
+    ///
+    void prefetchAsync(Font &font, std::string text, PrefetchDoneHandler done = nullptr);
+
+    /// @brief Wait for the completion of the background prefetch, if any.
+    void waitPrefetch();
+#endif
+
+    /// @brief Save the cached glyphs to a snapshot file
+    ///
+    /// The most recently used glyphs come first in the file, so that they are the ones
+    /// reloaded if the cache budget is smaller at load time.
+    ///
+    /// @param path In. The snapshot file name.
+    /// @param fontHash In. Identifies the font data the glyphs come from.
+    /// @param unhinted In. The glyphs were rendered from the outlines' cache, without hinting.
+    /// @return true if the snapshot has been written.
+    ///
+    auto saveSnapshot(const char *path, uint32_t fontHash, bool unhinted) -> bool;
+
+    /// @brief Load the glyphs of a snapshot file in the cache
+    ///
+    /// The snapshot is ignored if it is not readable, if its checksum does not match its
+    /// content, or if it was saved for another font, display resolution or rendering mode
+    /// (hinting and default 1 bit rendering).
+    ///
+    /// @param path In. The snapshot file name.
+    /// @param fontHash In. Identifies the font data in use.
+    /// @param unhinted In. The glyphs are rendered from the outlines' cache, without hinting.
+    /// @return true if the snapshot has been loaded.
+    ///
+    auto loadSnapshot(const char *path, uint32_t fontHash, bool unhinted) -> bool;
+
     void clear();
     void showStats() const;
 
+    /// @brief Set the maximum amount of memory, in bytes, used to keep the glyphs.
+    inline void setBudget(uint32_t budget) { store_.setBudget(budget); }
+
+    [[nodiscard]] inline auto getAllocatedBytes() const -> uint32_t {
+        return store_.getAllocatedBytes();
+    }
+
+    [[nodiscard]] inline auto getHitCount() const -> uint32_t { return hitCount_; }
+    [[nodiscard]] inline auto getMissCount() const -> uint32_t { return missCount_; }
+    [[nodiscard]] inline auto getEvictCount() const -> uint32_t { return evictCount_; }
+    [[nodiscard]] inline auto getMeasureHitCount() const -> uint32_t { return measureHitCount_; }
+    [[nodiscard]] inline auto getMeasureMissCount() const -> uint32_t { return measureMissCount_; }
+
     void showBitmap(const Bitmap &bitmap, bool inverted, PixelResolution pixelResolution) const;
 
     void showGlyph(const Glyph &glyph, bool displayBitmap, PixelResolution pixelResolution) const;
@@ -6,13 +6,86 @@
 
 const constexpr bool TTF_TRACING = false;
 
+// Memory budget of the glyphs' cache, in KB
+#ifndef CONFIG_TINYFONT_TTF_CACHE_SIZE
+#define CONFIG_TINYFONT_TTF_CACHE_SIZE 256
+#endif
+
+// Shelf-pack the cached glyph bitmaps in atlas pages
+#ifndef CONFIG_TINYFONT_TTF_CACHE_ATLAS
+#define CONFIG_TINYFONT_TTF_CACHE_ATLAS 0
+#endif
+
+// Allow glyphs to be prefetched on a background worker thread
+#ifndef CONFIG_TINYFONT_TTF_ASYNC_PREFETCH
+#define CONFIG_TINYFONT_TTF_ASYNC_PREFETCH 0
+#endif
+
+// Memory budget of the unscaled outlines' cache, in KB (0 = disabled)
+#ifndef CONFIG_TINYFONT_TTF_OUTLINE_CACHE_SIZE
+#define CONFIG_TINYFONT_TTF_OUTLINE_CACHE_SIZE 0
+#endif
+
+// Point size from which 8 bits glyphs are rasterized straight into the canvas (0 = never)
+#ifndef CONFIG_TINYFONT_TTF_DIRECT_RENDER_SIZE
+#define CONFIG_TINYFONT_TTF_DIRECT_RENDER_SIZE 48
+#endif
+
+// 1 bit glyphs derived from the cached 8 bits ones, thresholded or dithered, instead of
+// being rendered with monochrome hinting
+#ifndef CONFIG_TINYFONT_TTF_MONO_THRESHOLD
+#define CONFIG_TINYFONT_TTF_MONO_THRESHOLD 0
+#endif
+#ifndef CONFIG_TINYFONT_TTF_MONO_DITHER
+#define CONFIG_TINYFONT_TTF_MONO_DITHER 0
+#endif
+
+// Block size, in bytes, and number of blocks of the streamed fonts' read cache
+#ifndef CONFIG_TINYFONT_TTF_STREAM_BLOCK_SIZE
+#define CONFIG_TINYFONT_TTF_STREAM_BLOCK_SIZE 1024
+#endif
+#ifndef CONFIG_TINYFONT_TTF_STREAM_BLOCK_COUNT
+#define CONFIG_TINYFONT_TTF_STREAM_BLOCK_COUNT 16
+#endif
+
+// Serve FreeType's small allocations from size-class pools, in chunks of the given bytes
+#ifndef CONFIG_TINYFONT_TTF_MEMORY_POOL
+#define CONFIG_TINYFONT_TTF_MEMORY_POOL 1
+#endif
+#ifndef CONFIG_TINYFONT_TTF_MEMORY_CHUNK_SIZE
+#define CONFIG_TINYFONT_TTF_MEMORY_CHUNK_SIZE 4096
+#endif
+
+// Test mode: public access to the steps of the text drawing, for the hot paths benchmarks
+#ifndef CONFIG_TINYFONT_TTF_BENCH_ACCESS
+#define CONFIG_TINYFONT_TTF_BENCH_ACCESS 0
+#endif
+
+// Tool mode: access to the font metrics and glyph lookups a strike is built from, for the
+// TTFStrikeWriter of tools/ttf_strike
+#ifndef CONFIG_TINYFONT_TTF_STRIKE_ACCESS
+#define CONFIG_TINYFONT_TTF_STRIKE_ACCESS 0
+#endif
+
 namespace ttf_defs {
 
 const constexpr int SCREEN_RES_PER_INCH = CONFIG_TINYFONT_DISPLAY_DPI;
 const constexpr int SUP_SUB_FONT_DOWNSIZING = 2;
+const constexpr int DIRECT_RENDER_SIZE = CONFIG_TINYFONT_TTF_DIRECT_RENDER_SIZE;
 
 using namespace font_defs;
 
+// How the 1 bit glyphs are obtained (see Font::setMonoRendering())
+enum class MonoRendering : uint8_t { HINTED, THRESHOLD, ORDERED_DITHER };
+
+#if CONFIG_TINYFONT_TTF_MONO_DITHER
+const constexpr MonoRendering DEFAULT_MONO_RENDERING = MonoRendering::ORDERED_DITHER;
+#elif CONFIG_TINYFONT_TTF_MONO_THRESHOLD
+const constexpr MonoRendering DEFAULT_MONO_RENDERING = MonoRendering::THRESHOLD;
+#else
+const constexpr MonoRendering DEFAULT_MONO_RENDERING = MonoRendering::HINTED;
+#endif
+
 } // namespace ttf_defs
 
 #endif
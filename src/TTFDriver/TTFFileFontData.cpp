@@ -0,0 +1,19 @@
+#if CONFIG_TINYFONT_TTF
+
+#include "TTFFileFontData.hpp"
+
+TTFFileFontData::TTFFileFontData(const char *path, const char *privatePath) {
+    if (!file_.open(path)) {
+        LOGE("Unable to map TTF font file %s.", path);
+    }
+    if ((privatePath != nullptr) && !privateFile_.open(privatePath)) {
+        LOGE("Unable to map TTF private font file %s.", privatePath);
+    }
+}
+
+auto TTFFileFontData::ligKern(const GlyphCode glyphCode1, GlyphCode *glyphCode2, FIX16 *kern) const
+    -> bool {
+    return faceKern(glyphCode1, glyphCode2, kern);
+}
+
+#endif
@@ -0,0 +1,42 @@
+#pragma once
+
+#if CONFIG_TINYFONT_TTF
+
+#include "../Misc/MappedFile.hpp"
+#include "TTFFontData.hpp"
+
+/**
+ * @brief TTF font data read from font files.
+ *
+ * The files are mapped in memory (see MappedFile), FreeType reading the font tables in place.
+ * Kerning comes from the 'kern' table of the main font, if any. There is no ligature.
+ */
+class TTFFileFontData : public FontData {
+    MappedFile file_{};
+    MappedFile privateFile_{};
+
+public:
+    /// @brief Map **path** and, if not nullptr, **privatePath** for the private-use code points.
+    explicit TTFFileFontData(const char *path, const char *privatePath = nullptr);
+    ~TTFFileFontData() override = default;
+
+    /// @brief True if the main font file has been mapped.
+    [[nodiscard]] inline auto isOpen() const -> bool { return file_.isOpen(); }
+
+    auto ligKern(const GlyphCode glyphCode1, GlyphCode *glyphCode2, FIX16 *kern) const
+        -> bool override;
+
+    [[nodiscard]] auto getData() const -> MemoryPtr override { return file_.data(); }
+    [[nodiscard]] auto getDataSize() const -> int override {
+        return static_cast<int>(file_.size());
+    }
+
+    [[nodiscard]] auto getPrivateData() const -> MemoryPtr override {
+        return privateFile_.data();
+    }
+    [[nodiscard]] auto getPrivateDataSize() const -> int override {
+        return static_cast<int>(privateFile_.size());
+    }
+};
+
+#endif
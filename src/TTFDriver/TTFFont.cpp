@@ -3,10 +3,112 @@
 #include "TTFFont.hpp"
 
 #include <algorithm>
+#include <array>
 #include <cstdlib>
+#include <cstring>
 #include <execution>
 #include <optional>
 
+#include FT_OUTLINE_H
+
+Font::Font(FontData &fontData, int size) noexcept : fontData_(fontData), size_(size) {
+
+    if (!fontData_.isInitialized()) {
+        return;
+    }
+
+    // The sizes are created on faces a background prefetch may be using.
+    [[maybe_unused]] auto lock = fontData_.cache.lock();
+
+    if (const TTFStrike *strike = fontData_.getStrike(); strike != nullptr) {
+        if (const TTFStrike::SizeEntry *normal = strike->findSize(size_); normal != nullptr) {
+            // Without the sup/sub size in the strike, the normal one is used.
+            const TTFStrike::SizeEntry *supSub = strike->findSize(size_ - SUP_SUB_FONT_DOWNSIZING);
+            strike_ = strike;
+            strikeNormal_ = activeStrike_ = normal;
+            strikeSupSub_ = (supSub != nullptr) ? supSub : normal;
+            spaceSize_ = normal->spaceSize;
+            initialized_ = true;
+            return;
+        }
+    }
+
+    face_ = fontData_.getFace();
+    if (face_ == nullptr) {
+        return;
+    }
+    if (!newSize(face_, size_ * 64, normalSize_) ||
+        !newSize(face_, (size_ - SUP_SUB_FONT_DOWNSIZING) * 64, supSubSize_)) {
+        LOGE("Unable to set font size.");
+        return;
+    }
+    activeSize_ = normalSize_;
+
+    GlyphCode glyphCode = FT_Get_Char_Index(face_, ' ');
+
+    std::optional<const Glyph *> glyph = getCachedGlyph(glyphCode);
+
+    if (!glyph.has_value()) {
+        LOGE("Unable to load glyph for space char.");
+        spaceSize_ = 5 * 64; // Use a default size
+    } else {
+        spaceSize_ = glyph.value()->metrics.advance;
+    }
+
+    initialized_ = true;
+}
+
+auto Font::getPrivateFace() const -> FT_Face {
+    [[maybe_unused]] auto lock = fontData_.cache.lock();
+    if (!privateFaceTried_) {
+        privateFaceTried_ = true;
+
+        FT_Face face = fontData_.getPrivateFace();
+        if ((face == nullptr) || !newSize(face, size_ * 64, privateNormalSize_) ||
+            !newSize(face, (size_ - SUP_SUB_FONT_DOWNSIZING) * 64, privateSupSubSize_)) {
+            LOGE("Unable to set private font size.");
+        } else {
+            privateFace_ = face;
+            activePrivateSize_ = (subSupSize_ >= 0) ? privateSupSubSize_ : privateNormalSize_;
+        }
+    }
+    return privateFace_;
+}
+
+Font::~Font() {
+    [[maybe_unused]] auto lock = fontData_.cache.lock();
+    releaseScaledGlyph();
+    for (FT_Size size : {normalSize_, supSubSize_, privateNormalSize_, privateSupSubSize_}) {
+        if (size != nullptr) {
+            FT_Done_Size(size);
+        }
+    }
+}
+
+Font::Font(Font &&other) noexcept
+    : face_(other.face_), normalSize_(other.normalSize_), supSubSize_(other.supSubSize_),
+      activeSize_(other.activeSize_), privateFace_(other.privateFace_),
+      privateNormalSize_(other.privateNormalSize_), privateSupSubSize_(other.privateSupSubSize_),
+      activePrivateSize_(other.activePrivateSize_), privateFaceTried_(other.privateFaceTried_),
+      initialized_(other.initialized_), fontData_(other.fontData_), size_(other.size_),
+      subSupSize_(other.subSupSize_), spaceSize_(other.spaceSize_),
+      lastGlyphWidth_(other.lastGlyphWidth_),
+      displayPixelResolution_(other.displayPixelResolution_),
+      fontPixelResolution_(other.fontPixelResolution_), monoRendering_(other.monoRendering_),
+      scaledGlyph_(other.scaledGlyph_),
+      directRenderSize_(other.directRenderSize_), unknownGlyphCode_(other.unknownGlyphCode_),
+      strike_(other.strike_), strikeNormal_(other.strikeNormal_),
+      strikeSupSub_(other.strikeSupSub_), activeStrike_(other.activeStrike_),
+      strikePixels_(std::move(other.strikePixels_)) {
+
+    // The sizes now belong to this Font
+    other.normalSize_ = other.supSubSize_ = nullptr;
+    other.privateNormalSize_ = other.privateSupSubSize_ = nullptr;
+    other.activeSize_ = other.activePrivateSize_ = nullptr;
+    other.scaledGlyph_ = nullptr;
+    other.initialized_ = false;
+}
+
 /**
  * @brief Translate UTF32 codePoint to it's internal representation
  *
@@ -17,33 +119,61 @@
  * @return The internal representation of CodePoint
  */
 [[nodiscard]] auto Font::translate(char32_t codePoint) const -> GlyphCode {
-    GlyphCode glyphCode = unknownGlyphCode_;
+    font_stats::ScopedTimer timer(StatId::TRANSLATE, codePoint);
+    GlyphCode glyphCode = 0;
 
-    if ((codePoint == ' ') || (codePoint == 0xA0) || (codePoint == 0x202F) ||
-        ((codePoint >= 0x2000) && (codePoint <= 0x200F))) {
+    if (isSpace(codePoint)) {
         glyphCode = SPACE_CODE;
+    } else if (strike_ != nullptr) {
+        glyphCode = strike_->translate(codePoint);
     } else if ((codePoint >= 0xE000) && (codePoint <= 0xF8FF)) {
         // Those are codepoints in the private space. Their index starts at 0x8000.
-        glyphCode = FT_Get_Char_Index(privateFace_, codePoint) + 0x8000;
+        if (FT_Face face = getPrivateFace(); face != nullptr) {
+            glyphCode = FT_Get_Char_Index(face, codePoint) + 0x8000;
+        }
         // LOGW("glyphCode for CodePoint U+%05" PRIx32 ": %" PRIu16, codePoint, glyphCode);
     } else {
         glyphCode = FT_Get_Char_Index(face_, codePoint);
     }
 
     if (glyphCode == 0) {
-        glyphCode = unknownGlyphCode_;
+        glyphCode = getUnknownGlyphCode();
     }
 
-    // The following test could generates many entries in the log, depending on the quantity of
-    // unknown code points received to be translated. Could be removed or disabled if required.
     if ((codePoint != UNKNOWN_CODEPOINT) && (glyphCode == unknownGlyphCode_)) {
-        LOGW("Unknown Code Point received: U+%05" PRIx32, uint32_t(codePoint));
+        font_log::countUnknownCodePoint(codePoint);
     }
 
     return glyphCode;
 }
 
+auto Font::newSize(FT_Face face, FT_F26Dot6 charHeight, FT_Size &size) -> bool {
+    TTFMemoryPhaseGuard phase(TTFMemoryPhase::FACE_OPEN);
+    FT_Size current = face->size;
+
+    if (FT_New_Size(face, &size) != 0) {
+        size = nullptr;
+        return false;
+    }
+
+    // A new size has to be the active one of its face to be scaled.
+    FT_Activate_Size(size);
+    int error = FT_Set_Char_Size(face,                 // handle to face object
+                                 0,                    // char_width in 1/64th of points
+                                 charHeight,           // char_height in 1/64th of points
+                                 SCREEN_RES_PER_INCH,  // horizontal device resolution
+                                 SCREEN_RES_PER_INCH); // vertical device resolution
+    FT_Activate_Size(current);
+
+    return error == 0;
+}
+
 auto Font::ligKern(const GlyphCode glyphCode1, GlyphCode *glyphCode2, FIX16 *kern) const -> bool {
+    font_stats::ScopedTimer timer(StatId::LIG_KERN, glyphCode1, *glyphCode2);
+
+    if (strike_ != nullptr) {
+        return strike_->ligKern(*activeStrike_, glyphCode1, glyphCode2, kern);
+    }
 
     // Is not checking for private font
 
@@ -54,7 +184,7 @@ auto Font::ligKern(const GlyphCode glyphCode1, GlyphCode *glyphCode2, FIX16 *ker
     bool res = fontData_.ligKern(glyphCode1, glyphCode2, kern);
 
     if (*kern != 0) {
-        *kern = FT_MulFix(*kern, face_->size->metrics.x_scale);
+        *kern = FT_MulFix(*kern, activeSize_->metrics.x_scale);
     }
 
     return res;
@@ -66,8 +196,8 @@ auto Font::ligKern(const GlyphCode glyphCode1, GlyphCode *glyphCode2, FIX16 *ker
  *
  * This method copies a bitmap from a source buffer to a destination buffer, handling different
  * pixel resolutions and format conversions. It supports:
- * - Font pixel resolutions: 1-bit and 8-bit
- * - Display pixel resolutions: 1-bit, 8-bit, and 16-bit
+ * - Font pixel resolutions: 1-bit, 2-bit, 4-bit and 8-bit
+ * - Display pixel resolutions: 1-bit, 2-bit, 4-bit, 8-bit, 16-bit and 24-bit
  *
  * @param to Destination bitmap buffer where the content will be copied
  * @param from Source bitmap buffer containing the content to copy
@@ -86,11 +216,17 @@ auto Font::ligKern(const GlyphCode glyphCode1, GlyphCode *glyphCode2, FIX16 *ker
  * - With 16-bit display: Converts grayscale to RGB565 format
  * - With 8-bit display: Direct grayscale copy
  *
+ * For 2-bit and 4-bit font resolutions, the glyph is expanded to 8-bit for the displays of
+ * 8-bit and more. The 2-bit and 4-bit displays are served by copyBitmapToPacked().
+ *
  * @note The method assumes that the destination buffer has enough space allocated
  *       to accommodate the source bitmap at the specified position
  */
 void Font::copyBitmap(Bitmap &to, const Bitmap &from, Pos atPos, bool inverted) {
-    if (fontPixelResolution_ == font_defs::PixelResolution::ONE_BIT) {
+    if ((displayPixelResolution_ == PixelResolution::TWO_BITS) ||
+        (displayPixelResolution_ == PixelResolution::FOUR_BITS)) {
+        copyBitmapToPacked(to, from, atPos, inverted);
+    } else if (fontPixelResolution_ == font_defs::PixelResolution::ONE_BIT) {
 
         if (displayPixelResolution_ == PixelResolution::SIXTEEN_BITS) {
             uint16_t data;
@@ -253,38 +389,39 @@ void Font::copyBitmap(Bitmap &to, const Bitmap &from, Pos atPos, bool inverted)
                 }
             }
         }
-    } else { // Font Resolution EIGHT_BITS
+    } else { // Font Resolution EIGHT_BITS, 2 and 4 bits glyphs being expanded to it
+        const Bitmap gray = isPackedResolution(fontPixelResolution_) ? expandGlyph(from) : from;
         if (displayPixelResolution_ == PixelResolution::SIXTEEN_BITS) {
-            auto rowCount = from.dim.height;
-            auto fromPtr = from.pixels;
+            auto rowCount = gray.dim.height;
+            auto fromPtr = gray.pixels;
             auto toPtr =
                 reinterpret_cast<uint16_t *>(&to.pixels[(to.pitch * atPos.y + atPos.x) << 1]);
             while (rowCount-- > 0) {
                 if (inverted) {
-                    for (uint16_t i = 0; i < from.dim.width; i++) {
+                    for (uint16_t i = 0; i < gray.dim.width; i++) {
                         if (fromPtr[i] != 0) {
                             toPtr[i] = ((fromPtr[i] & 0xF8) << 8) | ((fromPtr[i] & 0xFC) << 3) |
                                        (fromPtr[i] >> 3);
                         }
                     }
                 } else {
-                    for (uint16_t i = 0; i < from.dim.width; i++) {
+                    for (uint16_t i = 0; i < gray.dim.width; i++) {
                         if (fromPtr[i] != 0) {
                             uint8_t val = 255 - fromPtr[i];
                             toPtr[i] = ((val & 0xF8) << 8) | ((val & 0xFC) << 3) | (val >> 3);
                         }
                     }
                 }
-                fromPtr += from.pitch;
+                fromPtr += gray.pitch;
                 toPtr += to.pitch;
             }
         } else if (displayPixelResolution_ == PixelResolution::TWENTYFOUR_BITS) {
-            auto rowCount = from.dim.height;
-            auto fromPtr = from.pixels;
+            auto rowCount = gray.dim.height;
+            auto fromPtr = gray.pixels;
             auto toPtr = &to.pixels[(to.pitch * atPos.y + atPos.x) * 3];
             while (rowCount-- > 0) {
                 if (inverted) {
-                    for (uint16_t i = 0; i < from.dim.width; i++) {
+                    for (uint16_t i = 0; i < gray.dim.width; i++) {
                         if (fromPtr[i] != 0) {
                             // Convert grayscale to RGB
                             uint8_t val = fromPtr[i];
@@ -294,7 +431,7 @@ void Font::copyBitmap(Bitmap &to, const Bitmap &from, Pos atPos, bool inverted)
                         }
                     }
                 } else {
-                    for (uint16_t i = 0; i < from.dim.width; i++) {
+                    for (uint16_t i = 0; i < gray.dim.width; i++) {
                         if (fromPtr[i] != 0) {
                             // Convert inverted grayscale to RGB
                             uint8_t val = 255 - fromPtr[i];
@@ -304,36 +441,282 @@ void Font::copyBitmap(Bitmap &to, const Bitmap &from, Pos atPos, bool inverted)
                         }
                     }
                 }
-                fromPtr += from.pitch;
+                fromPtr += gray.pitch;
                 toPtr += to.pitch * 3;
             }
         } else if (displayPixelResolution_ == PixelResolution::EIGHT_BITS) {
-            auto rowCount = from.dim.height;
-            auto fromPtr = from.pixels;
+            auto rowCount = gray.dim.height;
+            auto fromPtr = gray.pixels;
             auto toPtr = &to.pixels[to.pitch * atPos.y + atPos.x];
             while (rowCount-- > 0) {
                 if (inverted) {
-                    for (uint16_t i = 0; i < from.dim.width; i++) {
+                    for (uint16_t i = 0; i < gray.dim.width; i++) {
                         if (fromPtr[i] != 0) {
                             toPtr[i] = fromPtr[i];
                         }
                     }
                 } else {
-                    for (uint16_t i = 0; i < from.dim.width; i++) {
+                    for (uint16_t i = 0; i < gray.dim.width; i++) {
                         if (fromPtr[i] != 0) {
                             toPtr[i] = 255 - fromPtr[i];
                         }
                     }
                 }
-                fromPtr += from.pitch;
+                fromPtr += gray.pitch;
                 toPtr += to.pitch;
             }
         }
     }
 }
 
+namespace {
+
+// Mask of the non-zero **bits** wide pixels of a packed byte.
+inline auto inkMask(uint8_t pixels, int bits) -> uint8_t {
+    if (bits == 2) {
+        uint8_t set = (pixels | (pixels >> 1)) & 0x55;
+        return set | (set << 1);
+    }
+    uint8_t set = pixels | (pixels >> 1);
+    set = (set | (set >> 2)) & 0x11;
+    return set * 0x0F;
+}
+
+} // namespace
+
+// The display pixel levels are as for the 8 bits displays: the highest one is white. As with
+// the other displays, the glyph pixels without ink leave the canvas untouched.
+//
+// Glyphs of the display resolution are copied a byte at a time, the pixels of a glyph byte
+// landing in at most two canvas bytes. Other glyphs are requantized a pixel at a time.
+
+void Font::copyBitmapToPacked(Bitmap &to, const Bitmap &from, Pos atPos, bool inverted) {
+    const int toBits = bitsPerPixel(displayPixelResolution_);
+    const int toMax = (1 << toBits) - 1;
+    const int fromBits = glyphBitsPerPixel(fontPixelResolution_);
+    const int fromMax = (1 << fromBits) - 1;
+
+    auto fromPtr = from.pixels;
+    auto toPtr = to.pixels + static_cast<size_t>(atPos.y * to.pitch);
+
+    if (fromBits == toBits) {
+        const int shift = (atPos.x * toBits) & 7;
+        const uint16_t rowBytes = glyphRowBytes(from.dim.width, fontPixelResolution_);
+
+        for (uint16_t fromRow = 0; fromRow < from.dim.height;
+             fromRow++, toPtr += to.pitch, fromPtr += from.pitch) {
+            MemoryPtr rowPtr = toPtr + ((atPos.x * toBits) >> 3);
+            for (uint16_t i = 0; i < rowBytes; i++) {
+                uint8_t mask = inkMask(fromPtr[i], toBits);
+                if (mask == 0) {
+                    continue;
+                }
+                // For a field of n bits, the white level minus the ink level is its complement
+                auto ink = static_cast<uint8_t>((inverted ? fromPtr[i] : ~fromPtr[i]) & mask);
+                rowPtr[i] = (rowPtr[i] & ~(mask >> shift)) | (ink >> shift);
+                if (shift != 0) {
+                    auto lowMask = static_cast<uint8_t>(mask << (8 - shift));
+                    if (lowMask != 0) {
+                        rowPtr[i + 1] = (rowPtr[i + 1] & ~lowMask) |
+                                        static_cast<uint8_t>(ink << (8 - shift));
+                    }
+                }
+            }
+        }
+    } else {
+        for (uint16_t fromRow = 0; fromRow < from.dim.height;
+             fromRow++, toPtr += to.pitch, fromPtr += from.pitch) {
+            for (uint16_t i = 0; i < from.dim.width; i++) {
+                int fromBit = i * fromBits;
+                int level = (fromPtr[fromBit >> 3] >> (8 - fromBits - (fromBit & 7))) & fromMax;
+                level = requantize(level, fromMax, toMax);
+                if (level == 0) {
+                    continue;
+                }
+                int toBit = (atPos.x + i) * toBits;
+                int toShift = 8 - toBits - (toBit & 7);
+                uint8_t &pixels = toPtr[toBit >> 3];
+                pixels = (pixels & ~(toMax << toShift)) |
+                         ((inverted ? level : toMax - level) << toShift);
+            }
+        }
+    }
+}
+
+namespace {
+
+// Bytes of the threshold biases: a coverage carries out of its byte when added to its bias
+// if it reaches the threshold, 256 minus the bias.
+const constexpr uint64_t MID_GRAY_BIASES = 0x8080808080808080ULL;
+
+// Ordered dithering with the 8x8 Bayer matrix: the thresholds of the row y are the bytes of
+// DITHER_BIASES[y & 7], the one of x = 0 in the least significant byte. Level n of the matrix,
+// the bits of x ^ y and y interleaved from their lowest, has a threshold of 4n + 2.
+constexpr auto ditherBiases() -> std::array<uint64_t, 8> {
+    std::array<uint64_t, 8> biases{};
+    for (int y = 0; y < 8; y++) {
+        for (int x = 0; x < 8; x++) {
+            int level = 0;
+            for (int bit = 0; bit < 3; bit++) {
+                level = (level << 2) | ((((x ^ y) >> bit) & 1) << 1) | ((y >> bit) & 1);
+            }
+            biases[y] |= static_cast<uint64_t>(256 - (4 * level + 2)) << (8 * x);
+        }
+    }
+    return biases;
+}
+
+const constexpr std::array<uint64_t, 8> DITHER_BIASES = ditherBiases();
+
+// Up to 8 coverage bytes, the first one in the least significant byte, the missing ones
+// being 0.
+inline auto loadCoverage(const uint8_t *pixels, int count) -> uint64_t {
+    uint64_t word = 0;
+    if (count >= 8) {
+        std::memcpy(&word, pixels, 8);
+    } else {
+        std::memcpy(&word, pixels, count);
+    }
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    word = __builtin_bswap64(word);
+#endif
+    return word;
+}
+
+// Ink bits of 8 coverage bytes, the first one in the most significant bit. The bytes are
+// added to their biases in parallel, the carry out of each byte computed from its high bits
+// and the sum of its low ones. The carries are then gathered in the top byte.
+inline auto inkBits(uint64_t coverage, uint64_t biases) -> uint8_t {
+    constexpr uint64_t HIGH_BITS = 0x8080808080808080ULL;
+    uint64_t low = (coverage & ~HIGH_BITS) + (biases & ~HIGH_BITS);
+    uint64_t carries = ((coverage & biases) | ((coverage ^ biases) & low)) & HIGH_BITS;
+    return static_cast<uint8_t>(((carries >> 7) * 0x8040201008040201ULL) >> 56);
+}
+
+// Biases of the canvas row **y** from column **x**, in the byte order of loadCoverage().
+inline auto rowBiases(MonoRendering mode, int x, int y) -> uint64_t {
+    if (mode != MonoRendering::ORDERED_DITHER) {
+        return MID_GRAY_BIASES;
+    }
+    uint64_t biases = DITHER_BIASES[y & 7];
+    int rotation = 8 * (x & 7);
+    return (rotation == 0) ? biases : (biases >> rotation) | (biases << (64 - rotation));
+}
+
+} // namespace
+
+// The 1 bit glyphs derived from the 8 bits ones are thresholded at mid gray, or dithered with
+// a matrix anchored to the canvas so that the patterns of neighbouring glyphs line up. 8
+// pixels are converted at a time. On the 1 bit displays, they are merged straight into the
+// canvas, landing in at most two canvas bytes; the other displays receive a 1 bit glyph.
+
+void Font::copyBitmapAsMono(Bitmap &to, const Bitmap &from, Pos atPos, bool inverted) {
+    if (displayPixelResolution_ != PixelResolution::ONE_BIT) {
+        copyBitmap(to, deriveMonoGlyph(from, atPos), atPos, inverted);
+        return;
+    }
+
+    const int shift = atPos.x & 7;
+    auto fromPtr = from.pixels;
+    auto toPtr = to.pixels + static_cast<size_t>(atPos.y * to.pitch) + (atPos.x >> 3);
+
+    for (uint16_t fromRow = 0; fromRow < from.dim.height;
+         fromRow++, toPtr += to.pitch, fromPtr += from.pitch) {
+        uint64_t biases = rowBiases(monoRendering_, atPos.x, atPos.y + fromRow);
+        for (uint16_t i = 0; i < from.dim.width; i += 8) {
+            uint8_t bits = inkBits(loadCoverage(&fromPtr[i], from.dim.width - i), biases);
+            if (bits == 0) {
+                continue;
+            }
+            uint8_t &high = toPtr[i >> 3];
+            high = inverted ? (high | (bits >> shift)) : (high & ~(bits >> shift));
+            if (shift != 0) {
+                auto lowBits = static_cast<uint8_t>(bits << (8 - shift));
+                if (lowBits != 0) {
+                    uint8_t &low = toPtr[(i >> 3) + 1];
+                    low = inverted ? (low | lowBits) : (low & ~lowBits);
+                }
+            }
+        }
+    }
+}
+
+auto Font::deriveMonoGlyph(const Bitmap &from, Pos atPos) -> Bitmap {
+    const uint16_t rowBytes = glyphRowBytes(from.dim.width, PixelResolution::ONE_BIT);
+
+    monoPixels_.resize(static_cast<size_t>(rowBytes) * from.dim.height);
+
+    auto toPtr = monoPixels_.data();
+    auto fromPtr = from.pixels;
+    for (uint16_t row = 0; row < from.dim.height;
+         row++, toPtr += rowBytes, fromPtr += from.pitch) {
+        uint64_t biases = rowBiases(monoRendering_, atPos.x, atPos.y + row);
+        for (uint16_t i = 0; i < from.dim.width; i += 8) {
+            toPtr[i >> 3] = inkBits(loadCoverage(&fromPtr[i], from.dim.width - i), biases);
+        }
+    }
+
+    Bitmap mono = from;
+    mono.pixels = monoPixels_.data();
+    mono.pitch = rowBytes;
+    return mono;
+}
+
+auto Font::expandGlyph(const Bitmap &from) -> Bitmap {
+    const int bits = glyphBitsPerPixel(fontPixelResolution_);
+    const int max = (1 << bits) - 1;
+
+    expandedPixels_.resize(static_cast<size_t>(from.dim.width) * from.dim.height);
+
+    auto toPtr = expandedPixels_.data();
+    auto fromPtr = from.pixels;
+    for (uint16_t row = 0; row < from.dim.height; row++, fromPtr += from.pitch) {
+        for (uint16_t i = 0; i < from.dim.width; i++) {
+            int bit = i * bits;
+            int level = (fromPtr[bit >> 3] >> (8 - bits - (bit & 7))) & max;
+            *toPtr++ = static_cast<uint8_t>(level * 255 / max);
+        }
+    }
+
+    Bitmap expanded = from;
+    expanded.pixels = expandedPixels_.data();
+    expanded.pitch = from.dim.width;
+    return expanded;
+}
+
+void Font::packGlyph(Glyph &glyph) {
+    Bitmap &bitmap = glyph.bitmap;
+    if (bitmap.pixels == nullptr) {
+        return;
+    }
+
+    const int bits = bitsPerPixel(fontPixelResolution_);
+    const int max = (1 << bits) - 1;
+    const uint16_t rowBytes = glyphRowBytes(bitmap.dim.width, fontPixelResolution_);
+
+    packedPixels_.assign(static_cast<size_t>(rowBytes) * bitmap.dim.height, 0);
+
+    auto toPtr = packedPixels_.data();
+    auto fromPtr = bitmap.pixels;
+    for (uint16_t row = 0; row < bitmap.dim.height;
+         row++, toPtr += rowBytes, fromPtr += bitmap.pitch) {
+        for (uint16_t i = 0; i < bitmap.dim.width; i++) {
+            int bit = i * bits;
+            toPtr[bit >> 3] |= requantize(fromPtr[i], 255, max) << (8 - bits - (bit & 7));
+        }
+    }
+
+    bitmap.pixels = packedPixels_.data();
+    bitmap.pitch = rowBytes;
+}
+
 // Get a Glyph from the font to put in cache.
 //
+// The glyph bitmap is not copied: its pixels are pointing at the FreeType glyph slot
+// buffer and stay valid until the next glyph is loaded from the same face. The cache
+// is responsible to copy them in its own storage. 2 and 4 bits glyphs are rendered at 8 bits,
+// then packed in a buffer of the Font valid until the next glyph.
+//
 // Parameters:
 //
 //   glyphCode  : The index in the font to retrieve the glyph from
@@ -341,71 +724,329 @@ void Font::copyBitmap(Bitmap &to, const Bitmap &from, Pos atPos, bool inverted)
 
 auto Font::getGlyphForCache(GlyphCode glyphCode, Glyph &glyph) -> bool {
 
-    int error;
+    if (!renderGlyph(glyphCode, glyph)) {
+        return false;
+    }
+    if ((fontPixelResolution_ == PixelResolution::TWO_BITS) ||
+        (fontPixelResolution_ == PixelResolution::FOUR_BITS)) {
+        packGlyph(glyph);
+    }
+    return true;
+}
 
-    FT_Face theFace = (glyphCode >= 0x8000) ? privateFace_ : face_;
+auto Font::renderGlyph(GlyphCode glyphCode, Glyph &glyph) -> bool {
 
-    GlyphCode theGlyphCode = (glyphCode >= 0x8000) ? glyphCode - 0x8000 : glyphCode;
+    if (strike_ != nullptr) {
+        return strike_->getGlyph(*activeStrike_, renderPixelResolution(), glyphCode, glyph,
+                                 strikePixels_);
+    }
+
+    int error;
 
     glyph.clear();
 
-    error = FT_Load_Glyph(theFace,          /* handle to face object */
-                          theGlyphCode,     /* glyph index           */
-                          FT_LOAD_DEFAULT); /* load flags */
-    if (error) {
-        LOGE("Unable to load glyph for charcode: %d", theGlyphCode);
-        return false;
-    }
+    FT_Render_Mode renderMode = (renderPixelResolution() == font_defs::PixelResolution::ONE_BIT)
+                                    ? FT_RENDER_MODE_MONO
+                                    : FT_RENDER_MODE_NORMAL;
 
-    FT_GlyphSlot slot = theFace->glyph;
+    if (loadScaledOutline(glyphCode) != nullptr) {
+        FT_Pos advance = getScaledAdvance();
 
-    if (theFace->glyph->format != FT_GLYPH_FORMAT_BITMAP) {
-        if (fontPixelResolution_ == font_defs::PixelResolution::ONE_BIT) {
-            error = FT_Render_Glyph(theFace->glyph,       // glyph slot
-                                    FT_RENDER_MODE_MONO); // render mode
-        } else {
-            error = FT_Render_Glyph(theFace->glyph,         // glyph slot
-                                    FT_RENDER_MODE_NORMAL); // render mode
+        TTFMemoryPhaseGuard phase(TTFMemoryPhase::RENDER);
+        font_stats::ScopedTimer timer(StatId::GLYPH_RENDER, glyphCode);
+        error = FT_Glyph_To_Bitmap(&scaledGlyph_, renderMode, nullptr, 1);
+        if (error) {
+            LOGE("Unable to render glyph outline for charcode: %d error: %d", glyphCode, error);
+            return false;
         }
 
+        auto bitmapGlyph = reinterpret_cast<FT_BitmapGlyph>(scaledGlyph_);
+        setGlyph(glyph, bitmapGlyph->bitmap, bitmapGlyph->left, bitmapGlyph->top, advance,
+                 (glyphCode >= 0x8000) ? privateFace_ : face_);
+        return true;
+    }
+
+    FT_GlyphSlot slot = loadGlyph(glyphCode);
+    if (slot == nullptr) {
+        return false;
+    }
+
+    if (slot->format != FT_GLYPH_FORMAT_BITMAP) {
+        TTFMemoryPhaseGuard phase(TTFMemoryPhase::RENDER);
+        font_stats::ScopedTimer timer(StatId::GLYPH_RENDER, glyphCode);
+        error = FT_Render_Glyph(slot,        // glyph slot
+                                renderMode); // render mode
+
         if (error) {
-            LOGE("Unable to render glyph for charcode: %d error: %d", theGlyphCode, error);
+            LOGE("Unable to render glyph for charcode: %d error: %d", glyphCode, error);
             return false;
         }
     }
 
-    auto dim = Dim(slot->bitmap.width, slot->bitmap.rows);
+    setGlyph(glyph, slot->bitmap, slot->bitmap_left, slot->bitmap_top, slot->advance.x,
+             slot->face);
+    return true;
+}
 
-    glyph.bitmap.dim = dim;
-    glyph.bitmap.pitch = slot->bitmap.pitch;
+void Font::setGlyph(Glyph &glyph, const FT_Bitmap &bitmap, FT_Int left, FT_Int top,
+                    FT_Pos advance, FT_Face face) {
 
-    uint16_t size = dim.height * glyph.bitmap.pitch;
+    glyph.bitmap.dim = Dim(bitmap.width, bitmap.rows);
+    glyph.bitmap.pitch = bitmap.pitch;
+    glyph.bitmap.pixels = bitmap.buffer;
 
-    if (size > 0) {
-#if CONFIG_TINYFONT_USE_SPIRAM
-        glyph.bitmap.pixels =
-            static_cast<font_defs::MemoryPtr>(heap_caps_malloc(size, MALLOC_CAP_SPIRAM));
-#else
-        glyph.bitmap.pixels = static_cast<font_defs::MemoryPtr>(malloc(size));
-#endif
-        if (glyph.bitmap.pixels == nullptr) {
-            LOGE("Unable to allocate glyph pixel memory of size %d!", size);
-            glyph.bitmap.dim = Dim(0, 0);
-            return false;
-        }
-        memcpy(glyph.bitmap.pixels, slot->bitmap.buffer, size);
+    glyph.metrics = {.xoff = static_cast<int16_t>(-left),
+                     .yoff = static_cast<int16_t>(-top),
+                     .descent = static_cast<int16_t>(
+                         (bitmap.rows + top) > 0 ? bitmap.rows + top : 0),
+                     .advance = static_cast<FIX16>(advance),
+                     .lineHeight = static_cast<int16_t>(face->size->metrics.height >> 6)};
+}
+
+// Scale the cached unscaled outline of a glyph to the current size. The scaled outline is
+// kept in scaledGlyph_ until the next call.
+//
+// Returns nullptr if the outlines' cache is disabled or does not have the glyph.
+
+auto Font::loadScaledOutline(GlyphCode glyphCode) -> FT_Outline * {
+
+    if (!fontData_.outlines.isEnabled()) {
+        return nullptr;
+    }
+
+    TTFMemoryPhaseGuard phase(TTFMemoryPhase::LOAD_GLYPH);
+    font_stats::ScopedTimer timer(StatId::GLYPH_LOAD, glyphCode);
+
+    FT_Face theFace = (glyphCode >= 0x8000) ? getPrivateFace() : face_;
+    if (theFace == nullptr) {
+        return nullptr;
+    }
+
+    FT_OutlineGlyph unscaled = fontData_.outlines.get(theFace, glyphCode);
+    if (unscaled == nullptr) {
+        return nullptr;
     }
 
-    glyph.metrics = {.xoff = static_cast<int16_t>(-slot->bitmap_left),
-                     .yoff = static_cast<int16_t>(-slot->bitmap_top),
-                     .descent = static_cast<int16_t>((slot->bitmap.rows + slot->bitmap_top) > 0
-                                                         ? slot->bitmap.rows + slot->bitmap_top
-                                                         : 0),
-                     .advance = static_cast<FIX16>(slot->advance.x),
-                     .lineHeight = static_cast<int16_t>(theFace->size->metrics.height >> 6)};
+    releaseScaledGlyph();
+    if (FT_Glyph_Copy(reinterpret_cast<FT_Glyph>(unscaled), &scaledGlyph_) != 0) {
+        scaledGlyph_ = nullptr;
+        return nullptr;
+    }
+
+    // From font units to 26.6 pixels, the same scaling FreeType applies to unhinted glyphs
+    activateSizes();
+    FT_Matrix scale = {.xx = theFace->size->metrics.x_scale,
+                       .xy = 0,
+                       .yx = 0,
+                       .yy = theFace->size->metrics.y_scale};
+    FT_Glyph_Transform(scaledGlyph_, &scale, nullptr);
+
+    return &reinterpret_cast<FT_OutlineGlyph>(scaledGlyph_)->outline;
+}
+
+// Get the metrics of a glyph for the metrics cache, without rendering it.
+//
+// The bitmap position and size are computed from the hinted outline control box, the
+// same way FreeType presets them before rendering (ft_glyphslot_preset_bitmap()), so
+// they match the ones of the glyph bitmap put in cache by getGlyphForCache().
+//
+// Parameters:
+//
+//   glyphCode  : The index in the font to retrieve the glyph from
+//   measure    : The structure to put the metrics in
+
+auto Font::getMeasureForCache(GlyphCode glyphCode, TTFCache::Measure &measure) -> bool {
+
+    if (strike_ != nullptr) {
+        return strike_->getMeasure(*activeStrike_, renderPixelResolution(), glyphCode, measure);
+    }
+
+    if (const FT_Outline *outline = loadScaledOutline(glyphCode); outline != nullptr) {
+        setMeasure(measure, outlineBitmapBox(*outline), getScaledAdvance(),
+                   (glyphCode >= 0x8000) ? privateFace_ : face_);
+        return true;
+    }
+
+    FT_GlyphSlot slot = loadGlyph(glyphCode);
+    if (slot == nullptr) {
+        return false;
+    }
+
+    measureSlot(slot, measure);
     return true;
 }
 
+auto Font::loadGlyph(GlyphCode glyphCode) -> FT_GlyphSlot {
+
+    FT_Face theFace = (glyphCode >= 0x8000) ? getPrivateFace() : face_;
+    if (theFace == nullptr) {
+        return nullptr;
+    }
+
+    GlyphCode theGlyphCode = (glyphCode >= 0x8000) ? glyphCode - 0x8000 : glyphCode;
+
+    TTFMemoryPhaseGuard phase(TTFMemoryPhase::LOAD_GLYPH);
+    font_stats::ScopedTimer timer(StatId::GLYPH_LOAD, glyphCode);
+    activateSizes();
+    int error = FT_Load_Glyph(theFace, theGlyphCode, FT_LOAD_DEFAULT);
+    if (error) {
+        LOGE("Unable to load glyph for charcode: %d", theGlyphCode);
+        return nullptr;
+    }
+
+    return theFace->glyph;
+}
+
+void Font::measureSlot(FT_GlyphSlot slot, TTFCache::Measure &measure) const {
+
+    FT_BBox box;
+
+    if (slot->format == FT_GLYPH_FORMAT_OUTLINE) {
+        box = outlineBitmapBox(slot->outline);
+    } else {
+        box.xMin = slot->bitmap_left;
+        box.yMax = slot->bitmap_top;
+        box.xMax = box.xMin + slot->bitmap.width;
+        box.yMin = box.yMax - static_cast<FT_Pos>(slot->bitmap.rows);
+    }
+
+    setMeasure(measure, box, slot->advance.x, slot->face);
+}
+
+auto Font::outlineBitmapBox(const FT_Outline &outline) const -> FT_BBox {
+
+    FT_BBox cbox;
+    FT_Outline_Get_CBox(&outline, &cbox);
+
+    FT_Pos left, top, right, bottom;
+
+    if (renderPixelResolution() == PixelResolution::ONE_BIT) {
+        // Asymmetric rounding, so that the center of a pixel is always included. A
+        // collapsed box receives a pixel on the side of the total rounding error.
+        left = (cbox.xMin + 31) >> 6;
+        right = (cbox.xMax + 32) >> 6;
+        bottom = (cbox.yMin + 31) >> 6;
+        top = (cbox.yMax + 32) >> 6;
+        if (left == right) {
+            if ((((cbox.xMin + 31) & 63) - 31 + ((cbox.xMax + 32) & 63) - 32) < 0) {
+                left--;
+            } else {
+                right++;
+            }
+        }
+        if (bottom == top) {
+            if ((((cbox.yMin + 31) & 63) - 31 + ((cbox.yMax + 32) & 63) - 32) < 0) {
+                bottom--;
+            } else {
+                top++;
+            }
+        }
+    } else {
+        left = cbox.xMin >> 6;
+        bottom = cbox.yMin >> 6;
+        right = (cbox.xMax + 63) >> 6;
+        top = (cbox.yMax + 63) >> 6;
+    }
+
+    return FT_BBox{.xMin = left, .yMin = bottom, .xMax = right, .yMax = top};
+}
+
+void Font::setMeasure(TTFCache::Measure &measure, const FT_BBox &box, FT_Pos advance,
+                      FT_Face face) {
+
+    FT_Pos rows = box.yMax - box.yMin;
+
+    measure.width = static_cast<uint16_t>(box.xMax - box.xMin);
+    measure.metrics = {.xoff = static_cast<int16_t>(-box.xMin),
+                       .yoff = static_cast<int16_t>(-box.yMax),
+                       // As computed by setGlyph() from the unsigned bitmap row count
+                       .descent = static_cast<int16_t>(rows + box.yMax),
+                       .advance = static_cast<FIX16>(advance),
+                       .lineHeight = static_cast<int16_t>(face->size->metrics.height >> 6)};
+}
+
+auto Font::loadDirectGlyph(GlyphCode glyphCode, TTFCache::Measure &measure) -> FT_Outline * {
+
+    FT_Outline *outline = loadScaledOutline(glyphCode);
+
+    if (outline != nullptr) {
+        setMeasure(measure, outlineBitmapBox(*outline), getScaledAdvance(),
+                   (glyphCode >= 0x8000) ? privateFace_ : face_);
+    } else {
+        FT_GlyphSlot slot = loadGlyph(glyphCode);
+        if ((slot == nullptr) || (slot->format != FT_GLYPH_FORMAT_OUTLINE)) {
+            return nullptr;
+        }
+        measureSlot(slot, measure);
+        outline = &slot->outline;
+    }
+
+    // Outlines FreeType renders oversampled because of their overlapping contours, and
+    // embedded bitmaps, go through the cache.
+    return ((outline->flags & FT_OUTLINE_OVERLAP) != 0) ? nullptr : outline;
+}
+
+namespace {
+struct SpanTarget {
+    Bitmap &canvas;
+    int baseline; // Canvas row of the spans at y = 0
+    PixelResolution displayPixelResolution;
+    bool inverted;
+};
+} // namespace
+
+void Font::writeSpans(int y, int count, const FT_Span *spans, void *user) {
+    auto &target = *static_cast<SpanTarget *>(user);
+    int row = (target.baseline - y) * target.canvas.pitch;
+
+    for (; count > 0; count--, spans++) {
+        if (spans->coverage == 0) {
+            continue;
+        }
+        // Same conversions as copyBitmap()
+        uint8_t val = target.inverted ? spans->coverage : 255 - spans->coverage;
+        int idx = row + spans->x;
+
+        if (target.displayPixelResolution == PixelResolution::SIXTEEN_BITS) {
+            auto toPtr = reinterpret_cast<uint16_t *>(target.canvas.pixels) + idx;
+            std::fill_n(toPtr, spans->len,
+                        static_cast<uint16_t>(((val & 0xF8) << 8) | ((val & 0xFC) << 3) |
+                                              (val >> 3)));
+        } else if (target.displayPixelResolution == PixelResolution::TWENTYFOUR_BITS) {
+            std::fill_n(&target.canvas.pixels[idx * 3], spans->len * 3, val);
+        } else {
+            std::fill_n(&target.canvas.pixels[idx], spans->len, val);
+        }
+    }
+}
+
+// Rasterize a glyph outline straight into the canvas with FreeType's gray spans, without
+// going through a glyph bitmap and copyBitmap(). The outline is moved by whole pixels only,
+// so the coverage values are the same as the ones of the bitmap FT_Render_Glyph() would
+// produce. The spans are clipped to the canvas.
+
+void Font::drawGlyphDirect(Bitmap &canvas, FT_Outline &outline, Pos atPos, bool inverted) {
+
+    SpanTarget target{canvas, atPos.y - 1, displayPixelResolution_, inverted};
+
+    FT_Outline_Translate(&outline, static_cast<FT_Pos>(atPos.x) * 64, 0);
+
+    FT_Raster_Params params{};
+    params.source = &outline;
+    params.flags = FT_RASTER_FLAG_AA | FT_RASTER_FLAG_DIRECT | FT_RASTER_FLAG_CLIP;
+    params.gray_spans = writeSpans;
+    params.user = &target;
+    params.clip_box = {.xMin = 0,
+                       .yMin = atPos.y - canvas.dim.height,
+                       .xMax = canvas.dim.width,
+                       .yMax = atPos.y};
+
+    TTFMemoryPhaseGuard phase(TTFMemoryPhase::RENDER);
+    if (FT_Outline_Render(fontData_.getLibrary(), &outline, &params) != 0) {
+        LOGE("Unable to render glyph outline.");
+    }
+}
+
 auto Font::ligKernUTF8Map(const std::string &line, LigKernMappingHandler handler) const -> void {
     if (line.length() != 0) {
         auto iter = UTF8Iterator(line);
@@ -459,6 +1100,8 @@ auto Font::ligKernUTF8Map(const std::string &line, LigKernMappingHandler handler
 // Returns the x position at the end of string
 auto Font::drawSingleLineOfText(font_defs::Bitmap &canvas, font_defs::Pos pos,
                                 const std::string &line, bool inverted) -> int {
+    [[maybe_unused]] auto lock = fontData_.cache.lock();
+    font_stats::ScopedTimer timer(StatId::DRAW, line);
     font_defs::Pos atPos = pos;
 
     if constexpr (TTF_TRACING) {
@@ -473,38 +1116,61 @@ auto Font::drawSingleLineOfText(font_defs::Bitmap &canvas, font_defs::Pos pos,
         // The following may require some modification as the next Sol Glasses version
         // may be using a different pitch than the one computed here.
 
-        atPos.y += lineHeight() + (face_->size->metrics.descender >> 6);
+        atPos.y += lineHeight() + descender();
+
+        canvas.pitch = canvasPitch(canvas.dim.width, displayPixelResolution_);
 
-        canvas.pitch = (displayPixelResolution_ == PixelResolution::ONE_BIT)
-                           ? (canvas.dim.width + 7) >> 3
-                           : canvas.dim.width;
+        bool directRendering = isDirectRendering();
 
-        ligKernUTF8Map(line, [this, &canvas, &atPos, inverted](GlyphCode glyphCode, FIX16 kern,
-                                                               bool first, bool last) {
+        ligKernUTF8Map(line, [this, &canvas, &atPos, inverted, directRendering](
+                                 GlyphCode glyphCode, FIX16 kern, bool first, bool last) {
             if (glyphCode == SPACE_CODE) {
                 atPos.x += (spaceSize_ >> 6);
             } else {
-                std::optional<const Glyph *> glyph = fontData_.cache.getGlyph(
-                    *this, glyphCode, subSupSize_ >= 0 ? subSupSize_ : size_);
+                // Large glyphs are rasterized straight into the canvas, others come from
+                // the cache
+                TTFCache::Measure measure;
+                FT_Outline *outline = directRendering ? loadDirectGlyph(glyphCode, measure)
+                                                      : nullptr;
+                std::optional<const Glyph *> glyph;
+                const GlyphMetrics *metrics = nullptr;
+                uint16_t width = 0;
+
+                if (outline != nullptr) {
+                    metrics = &measure.metrics;
+                    width = measure.width;
+                } else if ((glyph = getCachedGlyph(glyphCode)).has_value()) {
+                    metrics = &glyph.value()->metrics;
+                    width = glyph.value()->bitmap.dim.width;
+                }
 
-                if (glyph.has_value()) {
+                if (metrics != nullptr) {
                     if (first) {
-                        atPos.x += glyph.value()->metrics.xoff;
+                        atPos.x += metrics->xoff;
                     }
 
-                    if (glyph.value()->bitmap.dim.width > 0) {
-                        lastGlyphWidth_ = glyph.value()->bitmap.dim.width;
-                        // TODO: Ask Guy about the right way to handle line height and keeping the
-                        // full text inside its box.
-                        Pos outPos = Pos(atPos.x - glyph.value()->metrics.xoff,
-                                         atPos.y + glyph.value()->metrics.yoff);
-                        copyBitmap(canvas, glyph.value()->bitmap, outPos, inverted);
+                    if (width > 0) {
+                        lastGlyphWidth_ = width;
+                        if (outline != nullptr) {
+                            font_stats::ScopedTimer timer(StatId::GLYPH_RENDER, glyphCode);
+                            drawGlyphDirect(canvas, *outline, atPos, inverted);
+                        } else {
+                            // TODO: Ask Guy about the right way to handle line height and
+                            // keeping the full text inside its box.
+                            Pos outPos = Pos(atPos.x - metrics->xoff, atPos.y + metrics->yoff);
+                            font_stats::ScopedTimer timer(StatId::BLIT, glyphCode);
+                            if (isMonoFromGray()) {
+                                copyBitmapAsMono(canvas, glyph.value()->bitmap, outPos, inverted);
+                            } else {
+                                copyBitmap(canvas, glyph.value()->bitmap, outPos, inverted);
+                            }
+                        }
                     }
 
                     // As advance is positive and greather than kern, we can shift right
                     // to get rid of the fix point decimals
-                    atPos.x += last ? lastGlyphWidth_ - (kern / 64) - glyph.value()->metrics.xoff
-                                    : ((glyph.value()->metrics.advance + kern) >> 6);
+                    atPos.x += last ? lastGlyphWidth_ - (kern / 64) - metrics->xoff
+                                    : ((metrics->advance + kern) >> 6);
                 }
             }
         });
@@ -514,6 +1180,8 @@ auto Font::drawSingleLineOfText(font_defs::Bitmap &canvas, font_defs::Pos pos,
 }
 
 auto Font::getTextSize(const std::string &buffer) -> font_defs::Dim {
+    [[maybe_unused]] auto lock = fontData_.cache.lock();
+    font_stats::ScopedTimer timer(StatId::MEASURE, buffer);
     font_defs::Dim dim = font_defs::Dim(0, 0);
     int16_t up = 0;
     int16_t down = 0;
@@ -524,16 +1192,13 @@ auto Font::getTextSize(const std::string &buffer) -> font_defs::Dim {
             if (glyphCode == SPACE_CODE) {
                 dim.width += spaceSize_ >> 6;
             } else {
-                std::optional<const Glyph *> glyph = fontData_.cache.getGlyph(
-                    *this, glyphCode, subSupSize_ >= 0 ? subSupSize_ : size_);
-                if (glyph.has_value()) {
-                    dim.width += last ? glyph.value()->bitmap.dim.width - (kern / 64) -
-                                            glyph.value()->metrics.xoff
-                                      : ((glyph.value()->metrics.advance + kern) >> 6);
-
-                    up = (up < glyph.value()->metrics.yoff) ? glyph.value()->metrics.yoff : up;
-                    down = (down < glyph.value()->metrics.descent) ? glyph.value()->metrics.descent
-                                                                   : down;
+                std::optional<TTFCache::Measure> measure = getCachedMeasure(glyphCode);
+                if (measure.has_value()) {
+                    dim.width += last ? measure->width - (kern / 64) - measure->metrics.xoff
+                                      : ((measure->metrics.advance + kern) >> 6);
+
+                    up = (up < measure->metrics.yoff) ? measure->metrics.yoff : up;
+                    down = (down < measure->metrics.descent) ? measure->metrics.descent : down;
                 }
             }
         });
@@ -545,6 +1210,8 @@ auto Font::getTextSize(const std::string &buffer) -> font_defs::Dim {
 }
 
 auto Font::getTextWidth(const std::string &buffer) -> int {
+    [[maybe_unused]] auto lock = fontData_.cache.lock();
+    font_stats::ScopedTimer timer(StatId::MEASURE, buffer);
     int width = 0;
     if (isInitialized()) {
         ligKernUTF8Map(buffer,
@@ -552,13 +1219,11 @@ auto Font::getTextWidth(const std::string &buffer) -> int {
             if (glyphCode == SPACE_CODE) {
                 width += spaceSize_ >> 6;
             } else {
-                std::optional<const Glyph *> glyph = fontData_.cache.getGlyph(
-                    *this, glyphCode, subSupSize_ >= 0 ? subSupSize_ : size_);
+                std::optional<TTFCache::Measure> measure = getCachedMeasure(glyphCode);
 
-                if (glyph.has_value()) {
-                    width += last ? glyph.value()->bitmap.dim.width - (kern / 64) -
-                                        glyph.value()->metrics.xoff
-                                  : ((glyph.value()->metrics.advance + kern) >> 6);
+                if (measure.has_value()) {
+                    width += last ? measure->width - (kern / 64) - measure->metrics.xoff
+                                  : ((measure->metrics.advance + kern) >> 6);
                 }
             }
         });
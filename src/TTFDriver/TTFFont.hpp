@@ -3,33 +3,75 @@
 #if CONFIG_TINYFONT_TTF
 
 #include <cstdio>
-#include <functional>
 
 #include "../Font.hpp"
+#include "../Misc/FunctionRef.hpp"
 #include "../UTF8Iterator.hpp"
 #include "TTFDefs.hpp"
 #include "TTFFontData.hpp"
+#include "TTFStrike.hpp"
+
+#include FT_GLYPH_H
+#include FT_SIZES_H
 
 class Font {
 private:
+    // The faces belong to the FontData and are shared by all its Fonts
     FT_Face face_{};
-    FT_Face privateFace_{};
+
+    // Scaling of each face at the normal and sup/sub sizes. They are the only per-size
+    // FreeType objects owned by a Font.
+    FT_Size normalSize_{};
+    FT_Size supSubSize_{};
+    FT_Size activeSize_{};
+
+    // Private-use code points are rare: the private face and its sizes are only set up
+    // by the first one met (see getPrivateFace()).
+    mutable FT_Face privateFace_{};
+    mutable FT_Size privateNormalSize_{};
+    mutable FT_Size privateSupSubSize_{};
+    mutable FT_Size activePrivateSize_{};
+    mutable bool privateFaceTried_{false};
 
     bool initialized_{false};
     FontData &fontData_;
     int size_;
     int subSupSize_{-1};
     FIX16 spaceSize_{0};
-    uint8_t lastGlyphWidth_{};
+    uint16_t lastGlyphWidth_{};
     PixelResolution displayPixelResolution_{DEFAULT_DISPLAY_PIXEL_RESOLUTION};
     PixelResolution fontPixelResolution_{DEFAULT_FONT_PIXEL_RESOLUTION};
+    MonoRendering monoRendering_{DEFAULT_MONO_RENDERING};
+
+    // Last outline scaled from the outlines' cache, or its rendered bitmap
+    FT_Glyph scaledGlyph_{};
+
+    // Point size from which glyphs are rasterized straight into the canvas (0 = never)
+    int directRenderSize_{DIRECT_RENDER_SIZE};
+
+    // Glyph of UNKNOWN_CODEPOINT, resolved on first use as it comes from the private face.
+    mutable GlyphCode unknownGlyphCode_{NO_GLYPH_CODE};
 
-    GlyphCode unknownGlyphCode_{0};
+    // Set when the strike of the FontData has the size of this Font: FreeType is not used.
+    const TTFStrike *strike_{nullptr};
+    const TTFStrike::SizeEntry *strikeNormal_{nullptr};
+    const TTFStrike::SizeEntry *strikeSupSub_{nullptr};
+    const TTFStrike::SizeEntry *activeStrike_{nullptr};
+    std::vector<uint8_t> strikePixels_{};
+
+    // 2 and 4 bits glyphs, packed from the 8 bits ones before being cached
+    std::vector<uint8_t> packedPixels_{};
+
+    // 2 and 4 bits glyphs expanded to 8 bits, for the displays of 8 bits and more
+    std::vector<uint8_t> expandedPixels_{};
+
+    // 1 bit glyphs derived from the 8 bits ones, for the displays of more than 1 bit
+    std::vector<uint8_t> monoPixels_{};
 
     // Maximum size of an allocated buffer to do vsnprintf formatting
     static constexpr int MAX_SIZE = 100;
 
-    typedef std::function<void(GlyphCode, FIX16, bool, bool)> const &LigKernMappingHandler;
+    typedef FunctionRef<void(GlyphCode, FIX16, bool, bool)> LigKernMappingHandler;
 
     /// @brief Ligature/Kerning/UTF8 Mapper
     ///
@@ -46,63 +88,144 @@ private:
 
     void copyBitmap(Bitmap &to, const Bitmap &from, Pos atPos, bool inverted);
 
-public:
-    Font(FontData &fontData, int size) noexcept : fontData_(fontData), size_(size) {
-
-        if (fontData_.isInitialized()) {
-            int error =
-                FT_New_Memory_Face(fontData_.getLibrary(), (const FT_Byte *)(fontData_.getData()),
-                                   fontData_.getDataSize(), 0, &face_);
-            if (error) {
-                LOGE("The memory of the main font format is unsupported or is broken (%d).", error);
-            } else {
-                int error = FT_Set_Char_Size(face_,               // handle to face object
-                                             0,                   // char_width in 1/64th of points
-                                             size_ * 64,          // char_height in 1/64th of points
-                                             SCREEN_RES_PER_INCH, // horizontal device resolution
-                                             SCREEN_RES_PER_INCH); // vertical device resolution
-                if (error) {
-                    LOGE("Unable to set font size.");
-                } else {
+    /// @brief copyBitmap() for the 2 and 4 bits displays, from glyphs of any resolution.
+    void copyBitmapToPacked(Bitmap &to, const Bitmap &from, Pos atPos, bool inverted);
 
-                    GlyphCode glyphCode = FT_Get_Char_Index(face_, ' ');
-
-                    std::optional<const Glyph *> glyph = fontData_.cache.getGlyph(
-                        *this, glyphCode, subSupSize_ >= 0 ? subSupSize_ : size_);
-
-                    if (!glyph.has_value()) {
-                        LOGE("Unable to load glyph for space char.");
-                        spaceSize_ = 5 * 64; // Use a default size
-                    } else {
-                        spaceSize_ = glyph.value()->metrics.advance;
-                    }
-
-                    error = FT_New_Memory_Face(fontData_.getLibrary(),
-                                               (const FT_Byte *)(fontData_.getPrivateData()),
-                                               fontData_.getPrivateDataSize(), 0, &privateFace_);
-                    if (error) {
-                        LOGE("The memory of the private font format is unsupported or is "
-                             "broken (%d).",
-                             error);
-                    } else {
-                        error =
-                            FT_Set_Char_Size(privateFace_,        // handle to face object
-                                             0,                   // char_width in 1/64th of points
-                                             size_ * 64,          // char_height in 1/64th of points
-                                             SCREEN_RES_PER_INCH, // horizontal device resolution
-                                             SCREEN_RES_PER_INCH); // vertical device resolution
-                        if (error) {
-                            LOGE("Unable to set private font size.");
-                        }
-
-                        unknownGlyphCode_ = translate(UNKNOWN_CODEPOINT);
-                        initialized_ = true;
-                    }
-                }
-            }
+    /// @brief **level**, out of **fromMax**, rounded to the nearest level out of **toMax**.
+    [[nodiscard]] static inline auto requantize(int level, int fromMax, int toMax) -> int {
+        return (level * toMax + (fromMax >> 1)) / fromMax;
+    }
+
+    /// @brief True if the 1 bit glyphs are derived while drawing from the 8 bits ones.
+    [[nodiscard]] inline auto isMonoFromGray() const -> bool {
+        return (fontPixelResolution_ == PixelResolution::ONE_BIT) &&
+               (monoRendering_ != MonoRendering::HINTED);
+    }
+
+    /// @brief Resolution of the glyphs kept in the cache.
+    [[nodiscard]] inline auto cachePixelResolution() const -> PixelResolution {
+        return isMonoFromGray() ? PixelResolution::EIGHT_BITS : fontPixelResolution_;
+    }
+
+    /// @brief Resolution glyphs are rendered at by FreeType or taken from a strike: 2 and
+    /// 4 bits glyphs are packed from the 8 bits ones.
+    [[nodiscard]] inline auto renderPixelResolution() const -> PixelResolution {
+        return (cachePixelResolution() == PixelResolution::ONE_BIT) ? PixelResolution::ONE_BIT
+                                                                    : PixelResolution::EIGHT_BITS;
+    }
+
+    /// @brief copyBitmap() of an 8 bits glyph as a 1 bit one, thresholded or dithered.
+    void copyBitmapAsMono(Bitmap &to, const Bitmap &from, Pos atPos, bool inverted);
+
+    /// @brief Ink bits of the 8 bits glyph **from** drawn at **atPos**, in monoPixels_.
+    auto deriveMonoGlyph(const Bitmap &from, Pos atPos) -> Bitmap;
+
+    /// @brief Pack the 8 bits bitmap of **glyph** to the 2 or 4 bits font pixel resolution.
+    void packGlyph(Glyph &glyph);
+
+    /// @brief Expand a 2 or 4 bits glyph bitmap to 8 bits, in expandedPixels_.
+    auto expandGlyph(const Bitmap &from) -> Bitmap;
+
+    /// @brief Render a glyph at renderPixelResolution().
+    auto renderGlyph(GlyphCode glyphCode, Glyph &glyph) -> bool;
+
+    /// @brief Add to **face** a size object scaled at **charHeight** (in 1/64th of points).
+    static auto newSize(FT_Face face, FT_F26Dot6 charHeight, FT_Size &size) -> bool;
+
+    /// @brief Load a glyph of the face it belongs to, at the current size.
+    /// @return The face glyph slot, or nullptr on error.
+    auto loadGlyph(GlyphCode glyphCode) -> FT_GlyphSlot;
+
+    auto loadScaledOutline(GlyphCode glyphCode) -> FT_Outline *;
+
+    inline void releaseScaledGlyph() {
+        if (scaledGlyph_ != nullptr) {
+            FT_Done_Glyph(scaledGlyph_);
+            scaledGlyph_ = nullptr;
+        }
+    }
+
+    /// @brief Advance of the scaled outline, in 26.6 pixels rounded as for hinted glyphs.
+    [[nodiscard]] inline auto getScaledAdvance() const -> FT_Pos {
+        return ((scaledGlyph_->advance.x >> 10) + 32) & -64;
+    }
+
+    /// @brief Fill **glyph** with a rendered **bitmap**, positioned at **left**, **top**.
+    static void setGlyph(Glyph &glyph, const FT_Bitmap &bitmap, FT_Int left, FT_Int top,
+                         FT_Pos advance, FT_Face face);
+
+    /// @brief Compute the metrics and width of the bitmap **slot** would be rendered into.
+    void measureSlot(FT_GlyphSlot slot, TTFCache::Measure &measure) const;
+
+    /// @brief Box, in pixels, of the bitmap FreeType renders **outline** into.
+    [[nodiscard]] auto outlineBitmapBox(const FT_Outline &outline) const -> FT_BBox;
+
+    static void setMeasure(TTFCache::Measure &measure, const FT_BBox &box, FT_Pos advance,
+                           FT_Face face);
+
+    [[nodiscard]] inline auto isDirectRendering() const -> bool {
+        int ptSize = (subSupSize_ >= 0) ? size_ - SUP_SUB_FONT_DOWNSIZING : size_;
+        return (strike_ == nullptr) && (directRenderSize_ > 0) && (ptSize >= directRenderSize_) &&
+               (fontPixelResolution_ == PixelResolution::EIGHT_BITS) &&
+               !isPackedResolution(displayPixelResolution_);
+    }
+
+    /// @brief Load the outline of a glyph to be rasterized straight into the canvas.
+    /// @return nullptr if the glyph must go through the cache instead.
+    auto loadDirectGlyph(GlyphCode glyphCode, TTFCache::Measure &measure) -> FT_Outline *;
+
+    /// @brief Rasterize **outline** into **canvas**, its origin at **atPos**.
+    void drawGlyphDirect(Bitmap &canvas, FT_Outline &outline, Pos atPos, bool inverted);
+
+    /// FreeType gray spans callback of drawGlyphDirect().
+    static void writeSpans(int y, int count, const FT_Span *spans, void *user);
+
+    /// @brief The private face, with the sizes of this Font set up on first call.
+    /// @return nullptr if the private face is not usable.
+    auto getPrivateFace() const -> FT_Face;
+
+    [[nodiscard]] inline auto getUnknownGlyphCode() const -> GlyphCode {
+        if (unknownGlyphCode_ == NO_GLYPH_CODE) {
+            // Glyph 0 of the main face, if the private one does not translate the code point
+            unknownGlyphCode_ = 0;
+            unknownGlyphCode_ = translate(UNKNOWN_CODEPOINT);
+        }
+        return unknownGlyphCode_;
+    }
+
+    /// @brief True for the code points drawn as a space of spaceSize_, without a glyph.
+    [[nodiscard]] static inline auto isSpace(char32_t codePoint) -> bool {
+        return (codePoint == ' ') || (codePoint == 0xA0) || (codePoint == 0x202F) ||
+               ((codePoint >= 0x2000) && (codePoint <= 0x200F));
+    }
+
+    /// @brief Distance from the baseline to the bottom of the line, in pixels (negative).
+    [[nodiscard]] inline auto descender() const -> int {
+        return (strike_ != nullptr) ? activeStrike_->descender
+                                    : activeSize_->metrics.descender >> 6;
+    }
+
+    // Another Font of the same FontData may have used the faces since the last call: the
+    // sizes of this Font are made active before any use of the faces' scaled values.
+    inline void activateSizes() {
+        if (face_->size != activeSize_) {
+            FT_Activate_Size(activeSize_);
+        }
+        if ((activePrivateSize_ != nullptr) && (privateFace_->size != activePrivateSize_)) {
+            FT_Activate_Size(activePrivateSize_);
         }
     }
-    ~Font() = default;
+
+public:
+    Font(FontData &fontData, int size) noexcept;
+
+    /// The FontData must outlive its Fonts.
+    ~Font();
+
+    Font(const Font &) = delete;
+    auto operator=(const Font &) -> Font & = delete;
+
+    Font(Font &&other) noexcept;
 
     [[nodiscard]] inline auto isInitialized() const -> bool {
         if (initialized_) {
@@ -117,23 +240,55 @@ public:
         if constexpr (TTF_TRACING) {
             LOGD("lineHeight()");
         }
-        return isInitialized() ? face_->size->metrics.height >> 6 : 0;
+        if (!isInitialized()) {
+            return 0;
+        }
+        return (strike_ != nullptr) ? activeStrike_->lineHeight : activeSize_->metrics.height >> 6;
     }
 
     [[nodiscard]] inline auto getFontData() const -> FontData * { return &fontData_; }
 
+    /// @brief True if the glyphs of this Font come from the strike of its FontData.
+    [[nodiscard]] inline auto isUsingStrike() const -> bool { return strike_ != nullptr; }
+
+    /// @brief True once a private-use code point made this Font set up the private face.
+    [[nodiscard]] inline auto isPrivateFaceOpen() const -> bool { return privateFace_ != nullptr; }
+
     auto getGlyphForCache(GlyphCode glyphCode, Glyph &glyph) -> bool;
 
+    /// @brief Retrieve a glyph from the cache at the current size and font pixel resolution.
+    /// The glyphs of a 1 bit font derived from the 8 bits ones are the 8 bits glyphs.
+    inline auto getCachedGlyph(GlyphCode glyphCode) -> std::optional<const Glyph *> {
+        [[maybe_unused]] auto lock = fontData_.cache.lock();
+        uint16_t ptSize = (subSupSize_ >= 0) ? size_ - SUP_SUB_FONT_DOWNSIZING : size_;
+        return fontData_.cache.getGlyph(*this, glyphCode, ptSize, cachePixelResolution());
+    }
+
+    auto getMeasureForCache(GlyphCode glyphCode, TTFCache::Measure &measure) -> bool;
+
+    /// @brief Retrieve the metrics of a glyph at the current size, without rendering it.
+    inline auto getCachedMeasure(GlyphCode glyphCode) -> std::optional<TTFCache::Measure> {
+        [[maybe_unused]] auto lock = fontData_.cache.lock();
+        uint16_t ptSize = (subSupSize_ >= 0) ? size_ - SUP_SUB_FONT_DOWNSIZING : size_;
+        return fontData_.cache.getMeasure(*this, glyphCode, ptSize, cachePixelResolution());
+    }
+
+    /// @brief Load the glyphs of **text** in the cache ahead of time. See TTFCache::prefetch().
+    inline auto prefetch(const std::string &text) -> uint32_t {
+        return fontData_.cache.prefetch(*this, text);
+    }
+
     [[nodiscard]] inline auto setDisplayPixelResolution(PixelResolution res) -> bool {
 #if CONFIG_TINYFONT_PIXEL_RESOLUTION_IS_FIX
         LOGW("The display does not allow to change it's pixel resolution!");
         return false;
 #else
+        [[maybe_unused]] auto lock = fontData_.cache.lock();
         if (initialized_) {
             if (displayPixelResolution_ != res) {
                 // check for coherence of fontPixelResolution
                 if ((res == PixelResolution::ONE_BIT) &&
-                    (fontPixelResolution_ == PixelResolution::EIGHT_BITS)) {
+                    (fontPixelResolution_ != PixelResolution::ONE_BIT)) {
                     setFontPixelResolution(PixelResolution::ONE_BIT);
                 }
                 displayPixelResolution_ = res;
@@ -148,15 +303,21 @@ public:
     }
 
     inline void setFontPixelResolution(PixelResolution res) {
+        [[maybe_unused]] auto lock = fontData_.cache.lock();
         if (initialized_) {
             if (fontPixelResolution_ != res) {
-                if ((res == PixelResolution::EIGHT_BITS) &&
-                    (displayPixelResolution_ != PixelResolution::EIGHT_BITS)) {
-                    LOGE(
-                        "Cannot set font resolution to EIGHT_BITS if the display resolution is not "
-                        "EIGHT_BITS!");
+                bool grayDisplay = (displayPixelResolution_ == PixelResolution::EIGHT_BITS) ||
+                                   (displayPixelResolution_ == PixelResolution::TWO_BITS) ||
+                                   (displayPixelResolution_ == PixelResolution::FOUR_BITS);
+                if ((res == PixelResolution::EIGHT_BITS) && !grayDisplay) {
+                    LOGE("Cannot set font resolution to EIGHT_BITS if the display resolution is "
+                         "not grayscale!");
+                } else if (((res == PixelResolution::TWO_BITS) ||
+                            (res == PixelResolution::FOUR_BITS)) &&
+                           (displayPixelResolution_ == PixelResolution::ONE_BIT)) {
+                    LOGE("Cannot set a grayscale font resolution on a ONE_BIT display!");
                 } else {
-                    fontData_.cache.clear();
+                    // Glyphs of both resolutions are kept apart in the cache.
                     fontPixelResolution_ = res;
                 }
             }
@@ -167,6 +328,22 @@ public:
         return (initialized_) ? fontPixelResolution_ : DEFAULT_FONT_PIXEL_RESOLUTION;
     }
 
+    /// @brief Choose how the 1 bit glyphs are obtained: rendered by FreeType with monochrome
+    /// hinting, or derived while drawing from the cached 8 bits glyphs, by thresholding or
+    /// ordered dithering. The derived ones share the cache entries of the 8 bits glyphs.
+    inline void setMonoRendering(MonoRendering mode) {
+        [[maybe_unused]] auto lock = fontData_.cache.lock();
+        monoRendering_ = mode;
+    }
+
+    [[nodiscard]] inline auto getMonoRendering() const -> MonoRendering { return monoRendering_; }
+
+    /// @brief Set the point size from which 8 bits glyphs are rasterized straight into the
+    /// canvas instead of going through the cache. 0 disables it.
+    inline void setDirectRenderSize(int size) { directRenderSize_ = size; }
+
+    [[nodiscard]] inline auto getDirectRenderSize() const -> int { return directRenderSize_; }
+
     [[nodiscard]] auto translate(char32_t codePoint) const -> GlyphCode;
 
     auto drawSingleLineOfText(font_defs::Bitmap &canvas, font_defs::Pos pos,
@@ -183,6 +360,7 @@ public:
     // inline auto getTextWidthQuick(const char *buffer) -> int { return getTextWidth(buffer); }
     inline auto getTextWidthQuick(const char *buffer) -> int16_t {
 
+        [[maybe_unused]] auto lock = fontData_.cache.lock();
         int16_t width = 0;
 
         while (*buffer) {
@@ -192,12 +370,10 @@ public:
             if (glyphCode == SPACE_CODE) {
                 width += spaceSize_ >> 6;
             } else {
-                std::optional<const Glyph *> glyph = fontData_.cache.getGlyph(
-                    *this, glyphCode, subSupSize_ >= 0 ? subSupSize_ : size_);
-                if (glyph.has_value()) {
-                    width += (*buffer == '\0')
-                                 ? (glyph.value()->bitmap.dim.width - glyph.value()->metrics.xoff)
-                                 : (glyph.value()->metrics.advance >> 6);
+                std::optional<TTFCache::Measure> measure = getCachedMeasure(glyphCode);
+                if (measure.has_value()) {
+                    width += (*buffer == '\0') ? (measure->width - measure->metrics.xoff)
+                                                : (measure->metrics.advance >> 6);
                 }
             }
         }
@@ -206,28 +382,71 @@ public:
     }
 
     inline void setSupSubFontSize() {
+        [[maybe_unused]] auto lock = fontData_.cache.lock();
         subSupSize_ = (size_ - SUP_SUB_FONT_DOWNSIZING) * 64;
-        int error = FT_Set_Char_Size(face_,                // handle to face object
-                                     0,                    // char_width in 1/64th of points
-                                     subSupSize_,          // char_height in 1/64th of points
-                                     SCREEN_RES_PER_INCH,  // horizontal device resolution
-                                     SCREEN_RES_PER_INCH); // vertical device resolution
-        if (error) {
-            LOGE("Unable to set font size.");
-        }
+        activeSize_ = supSubSize_;
+        activePrivateSize_ = privateSupSubSize_;
+        activeStrike_ = strikeSupSub_;
     }
 
     inline void setNormalFontSize() {
+        [[maybe_unused]] auto lock = fontData_.cache.lock();
         subSupSize_ = -1;
-        int error = FT_Set_Char_Size(face_,                // handle to face object
-                                     0,                    // char_width in 1/64th of points
-                                     size_ * 64,           // char_height in 1/64th of points
-                                     SCREEN_RES_PER_INCH,  // horizontal device resolution
-                                     SCREEN_RES_PER_INCH); // vertical device resolution
-        if (error) {
-            LOGE("Unable to set font size.");
+        activeSize_ = normalSize_;
+        activePrivateSize_ = privateNormalSize_;
+        activeStrike_ = strikeNormal_;
+    }
+
+#if CONFIG_TINYFONT_TTF_BENCH_ACCESS
+    /// @brief ligKern(), for the hot paths benchmarks.
+    inline auto benchLigKern(GlyphCode glyphCode1, GlyphCode *glyphCode2, FIX16 *kern) const
+        -> bool {
+        return ligKern(glyphCode1, glyphCode2, kern);
+    }
+
+    /// @brief The glyph bitmap copy of drawSingleLineOfText(), for the hot paths benchmarks.
+    inline void benchCopyBitmap(Bitmap &to, const Bitmap &from, Pos atPos) {
+        if (isMonoFromGray()) {
+            copyBitmapAsMono(to, from, atPos, false);
+        } else {
+            copyBitmap(to, from, atPos, false);
         }
     }
+#endif
+
+#if CONFIG_TINYFONT_TTF_STRIKE_ACCESS
+    /// @brief Glyph code of a code point, as translate() finds it, without logging the unknown
+    /// ones. 0 if the font has no glyph for it or draws it as a space.
+    [[nodiscard]] inline auto strikeGlyphCode(char32_t codePoint) const -> GlyphCode {
+        if (isSpace(codePoint)) {
+            return 0;
+        }
+        if ((codePoint >= 0xE000) && (codePoint <= 0xF8FF)) {
+            FT_Face face = getPrivateFace();
+            GlyphCode glyphCode = (face != nullptr) ? FT_Get_Char_Index(face, codePoint) : 0;
+            return (glyphCode != 0) ? glyphCode + 0x8000 : 0;
+        }
+        return FT_Get_Char_Index(face_, codePoint);
+    }
+
+    [[nodiscard]] inline auto strikeUnknownGlyphCode() const -> GlyphCode {
+        return getUnknownGlyphCode();
+    }
+
+    inline auto strikeLigKern(GlyphCode glyphCode1, GlyphCode *glyphCode2, FIX16 *kern) const
+        -> bool {
+        return ligKern(glyphCode1, glyphCode2, kern);
+    }
+
+    [[nodiscard]] inline auto strikeDescender() const -> int16_t {
+        return static_cast<int16_t>(activeSize_->metrics.descender >> 6);
+    }
+
+    [[nodiscard]] inline auto strikeSpaceSize() const -> FIX16 { return spaceSize_; }
+
+    /// @brief Render the glyphs at **res**, whatever the display resolution.
+    inline void strikeFontPixelResolution(PixelResolution res) { fontPixelResolution_ = res; }
+#endif
 };
 
 #endif
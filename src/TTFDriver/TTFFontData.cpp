@@ -4,45 +4,16 @@
 
 #include <freetype/ftmodapi.h>
 
-FT_Library FontData::library = nullptr;
-
-static auto myFtAlloc(FT_Memory memory, long size) -> void * {
-#if CONFIG_TINYFONT_USE_SPIRAM
-    return heap_caps_malloc(static_cast<size_t>(size), MALLOC_CAP_SPIRAM);
-#else
-    return malloc(static_cast<size_t>(size));
-#endif
-}
-
-static auto myFtRealloc(FT_Memory memory, long currSize, long newSize, void *block) -> void * {
-#if CONFIG_TINYFONT_USE_SPIRAM
-    return heap_caps_realloc(block, static_cast<size_t>(newSize), MALLOC_CAP_SPIRAM);
-#else
-    return realloc(block, static_cast<size_t>(newSize));
-#endif
-}
-
-static void myFtFree(FT_Memory memory, void *block) {
-#if CONFIG_TINYFONT_USE_SPIRAM
-    heap_caps_free(block);
-#else
-    free(block);
-#endif
-}
+#include "../Misc/FNVHash.hpp"
 
-static FT_MemoryRec_ ftMemory = {
-    nullptr,
-    myFtAlloc,
-    myFtFree,
-    myFtRealloc,
-};
+FT_Library FontData::library = nullptr;
 
 auto FontData::load() -> bool {
 
     initialized_ = false;
 
     if (library == nullptr) {
-        FT_Error error = FT_New_Library(&ftMemory, &library);
+        FT_Error error = FT_New_Library(TTFMemory::getMemory(), &library);
         if (error) {
             LOGE("An error occurred during FreeType library initialization.");
         }
@@ -54,4 +25,60 @@ auto FontData::load() -> bool {
     return true;
 }
 
-#endif
\ No newline at end of file
+FontData::~FontData() { closeFaces(); }
+
+void FontData::closeFaces() {
+    if (face_ != nullptr) {
+        FT_Done_Face(face_);
+        face_ = nullptr;
+    }
+    if (privateFace_ != nullptr) {
+        FT_Done_Face(privateFace_);
+        privateFace_ = nullptr;
+    }
+}
+
+auto FontData::openMainFace(FT_Face &face) -> bool {
+    return (getData() != nullptr) && openFace(getData(), getDataSize(), face);
+}
+
+auto FontData::openFace(MemoryPtr data, int size, FT_Face &face) -> bool {
+    int error = FT_New_Memory_Face(library, (const FT_Byte *)data, size, 0, &face);
+    if (error) {
+        LOGE("The memory of the font format is unsupported or is broken (%d).", error);
+        face = nullptr;
+        return false;
+    }
+    return true;
+}
+
+auto FontData::faceKern(const GlyphCode glyphCode1, GlyphCode *glyphCode2, FIX16 *kern) const
+    -> bool {
+
+    *kern = 0;
+
+    // Called by the Fonts once the main face is opened.
+
+    if ((face_ != nullptr) && FT_HAS_KERNING(face_)) {
+        FT_Vector delta;
+        if (FT_Get_Kerning(face_, glyphCode1, *glyphCode2, FT_KERNING_UNSCALED, &delta) == 0) {
+            *kern = static_cast<FIX16>(delta.x);
+        }
+    }
+
+    return false;
+}
+
+auto FontData::getDataHash() const -> uint32_t {
+    // Computed once, the font data being immutable.
+    if (dataHash_ == 0) {
+        uint32_t hash = fnv1a(getData(), getDataSize());
+        if (getPrivateData() != nullptr) {
+            hash = fnv1a(getPrivateData(), getPrivateDataSize(), hash);
+        }
+        dataHash_ = (hash == 0) ? 1 : hash;
+    }
+    return dataHash_;
+}
+
+#endif
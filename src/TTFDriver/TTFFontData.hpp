@@ -9,6 +9,9 @@
 #include "../TTFFonts/NotoSans-Light.h"
 #include "TTFCache.hpp"
 #include "TTFDefs.hpp"
+#include "TTFMemory.hpp"
+#include "TTFOutlineCache.hpp"
+#include "TTFStrike.hpp"
 
 using namespace ttf_defs;
 using namespace font_defs;
@@ -28,6 +31,23 @@ private:
     static FT_Library library;
 
     bool initialized_{false};
+    mutable uint32_t dataHash_{0};
+
+    // Opened on first use, shared by all the Fonts built on this FontData
+    FT_Face face_{nullptr};
+    FT_Face privateFace_{nullptr};
+
+    auto openFace(MemoryPtr data, int size, FT_Face &face) -> bool;
+
+protected:
+    /// @brief Open the main face. From getData() in memory, unless overridden.
+    virtual auto openMainFace(FT_Face &face) -> bool;
+
+    /// @brief Done the faces. For subclasses whose faces depend on their own members.
+    void closeFaces();
+
+    /// @brief ligKern() from the 'kern' table of the main face: no ligature.
+    auto faceKern(const GlyphCode glyphCode1, GlyphCode *glyphCode2, FIX16 *kern) const -> bool;
 
 public:
     FontData() {
@@ -39,9 +59,13 @@ public:
         }
     }
 
-    virtual ~FontData() = default;
+    virtual ~FontData();
+
+    FontData(const FontData &) = delete;
+    auto operator=(const FontData &) -> FontData & = delete;
 
     TTFCache cache{};
+    TTFOutlineCache outlines{};
 
     [[nodiscard]] inline auto isInitialized() const -> bool { return initialized_; }
     [[nodiscard]] inline auto getLibrary() const -> FT_Library { return library; }
@@ -55,5 +79,41 @@ public:
     virtual auto ligKern(const GlyphCode glyphCode1, GlyphCode *glyphCode2, FIX16 *kern) const
         -> bool = 0;
 
+    /// @brief Pre-rasterized glyphs used instead of FreeType by the Fonts of the sizes it
+    /// holds. None unless overridden.
+    [[nodiscard]] virtual auto getStrike() const -> const TTFStrike * { return nullptr; }
+
     auto load() -> bool;
+
+    /// @brief The main face, opened on first call. nullptr if the font data is not usable.
+    [[nodiscard]] inline auto getFace() -> FT_Face {
+        if (face_ == nullptr) {
+            TTFMemoryPhaseGuard phase(TTFMemoryPhase::FACE_OPEN);
+            openMainFace(face_);
+        }
+        return face_;
+    }
+
+    /// @brief The private face, opened on first call. nullptr if the font data is not usable
+    /// or if there is no private font data.
+    [[nodiscard]] inline auto getPrivateFace() -> FT_Face {
+        if ((privateFace_ == nullptr) && (getPrivateData() != nullptr)) {
+            TTFMemoryPhaseGuard phase(TTFMemoryPhase::FACE_OPEN);
+            openFace(getPrivateData(), getPrivateDataSize(), privateFace_);
+        }
+        return privateFace_;
+    }
+
+    /// @brief Hash of the main and private font data, identifying them in cache snapshots.
+    [[nodiscard]] virtual auto getDataHash() const -> uint32_t;
+
+    /// @brief Save the glyphs' cache to **path**. See TTFCache::saveSnapshot().
+    inline auto saveCacheSnapshot(const char *path) -> bool {
+        return cache.saveSnapshot(path, getDataHash(), outlines.isEnabled());
+    }
+
+    /// @brief Load the glyphs' cache from **path**. See TTFCache::loadSnapshot().
+    inline auto loadCacheSnapshot(const char *path) -> bool {
+        return cache.loadSnapshot(path, getDataHash(), outlines.isEnabled());
+    }
 };
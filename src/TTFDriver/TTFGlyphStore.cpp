@@ -0,0 +1,219 @@
+#if CONFIG_TINYFONT_TTF
+
+#include "TTFGlyphStore.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#if CONFIG_TINYFONT_TTF_CACHE_ATLAS
+
+auto TTFGlyphStore::allocatePixels(Record &rec, PixelResolution resolution, uint16_t width,
+                                   uint16_t height) -> bool {
+
+    uint32_t budget = (allocatedBytes_ < budget_) ? budget_ - allocatedBytes_ : 0;
+    int32_t size = atlas_.allocate(resolution, width, height, budget, rec.location);
+    if (size < 0) {
+        return false;
+    }
+    allocatedBytes_ += size;
+
+    rec.glyph.bitmap.pixels = atlas_.getPixels(rec.location);
+    rec.glyph.bitmap.pitch = atlas_.getPitch(rec.location.page);
+    return true;
+}
+
+#else
+
+auto TTFGlyphStore::allocatePixels(Index owner, uint32_t size) -> MemoryPtr {
+
+    uint32_t blockSize = sizeof(BlockHeader) + ((size + 3) & ~3U);
+
+    PixelPage *target = nullptr;
+    for (auto &page : pixelPages_) {
+        if ((page.size - page.used) >= blockSize) {
+            target = &page;
+            break;
+        }
+    }
+
+    if (target == nullptr) {
+        uint32_t pageSize = (blockSize > PIXEL_PAGE_SIZE) ? blockSize : PIXEL_PAGE_SIZE;
+        if ((allocatedBytes_ + pageSize) > budget_) {
+            return nullptr;
+        }
+        auto data = static_cast<MemoryPtr>(fontMalloc(pageSize));
+        if (data == nullptr) {
+            return nullptr;
+        }
+        allocatedBytes_ += pageSize;
+        pixelPages_.push_back({.data = data, .size = pageSize, .used = 0});
+        target = &pixelPages_.back();
+    }
+
+    auto header = reinterpret_cast<BlockHeader *>(target->data + target->used);
+    header->size = blockSize;
+    header->owner = owner;
+    target->used += blockSize;
+
+    return reinterpret_cast<MemoryPtr>(header + 1);
+}
+
+#endif
+
+auto TTFGlyphStore::insert(uint32_t key, const Glyph &glyph, PixelResolution resolution) -> Index {
+
+    if (freeRecords_.empty()) {
+        if ((allocatedBytes_ + sizeof(Record) * RECORDS_PER_PAGE) > budget_) {
+            return NO_INDEX;
+        }
+        auto page = static_cast<Record *>(fontMalloc(sizeof(Record) * RECORDS_PER_PAGE));
+        if (page == nullptr) {
+            return NO_INDEX;
+        }
+        allocatedBytes_ += sizeof(Record) * RECORDS_PER_PAGE;
+
+        // The slot of a released record page is reused before growing the pages list.
+        auto slot = std::find(recordPages_.begin(), recordPages_.end(), nullptr);
+        auto pageIdx = static_cast<Index>(slot - recordPages_.begin());
+        if (slot == recordPages_.end()) {
+            recordPages_.push_back(page);
+        } else {
+            *slot = page;
+        }
+        for (Index i = RECORDS_PER_PAGE; i > 0; i--) {
+            page[i - 1].key = NO_INDEX;
+            freeRecords_.push_back((pageIdx << RECORDS_PER_PAGE_SHIFT) + i - 1);
+        }
+    }
+
+    Index idx = freeRecords_.back();
+    Record &rec = record(idx);
+
+    rec.glyph = glyph;
+    rec.glyph.bitmap.pixels = nullptr;
+
+    const Bitmap &from = glyph.bitmap;
+    if ((from.pixels != nullptr) && (from.dim.width > 0) && (from.dim.height > 0)) {
+        uint16_t width = glyphRowBytes(from.dim.width, resolution);
+#if CONFIG_TINYFONT_TTF_CACHE_ATLAS
+        if (!allocatePixels(rec, resolution, width, from.dim.height)) {
+            return NO_INDEX;
+        }
+#else
+        MemoryPtr pixels = allocatePixels(idx, width * from.dim.height);
+        if (pixels == nullptr) {
+            return NO_INDEX;
+        }
+        rec.glyph.bitmap.pixels = pixels;
+        rec.glyph.bitmap.pitch = width;
+#endif
+
+        MemoryPtr toPtr = rec.glyph.bitmap.pixels;
+        MemoryPtr fromPtr = from.pixels;
+        for (int row = 0; row < from.dim.height;
+             row++, toPtr += rec.glyph.bitmap.pitch, fromPtr += from.pitch) {
+            memcpy(toPtr, fromPtr, width);
+        }
+    } else {
+        rec.glyph.bitmap.dim = Dim(0, 0);
+        rec.glyph.bitmap.pitch = 0;
+    }
+
+    rec.key = key;
+    rec.lastUse = 0;
+    freeRecords_.pop_back();
+    recordCount_++;
+
+    return idx;
+}
+
+void TTFGlyphStore::release(Index idx) {
+    Record &rec = record(idx);
+
+    if (rec.glyph.bitmap.pixels != nullptr) {
+#if CONFIG_TINYFONT_TTF_CACHE_ATLAS
+        allocatedBytes_ -= atlas_.release(rec.location.page);
+#else
+        // The block is reclaimed by the next compaction.
+        (reinterpret_cast<BlockHeader *>(rec.glyph.bitmap.pixels) - 1)->owner = NO_INDEX;
+#endif
+        rec.glyph.bitmap.pixels = nullptr;
+    }
+    rec.key = NO_INDEX;
+    freeRecords_.push_back(idx);
+    recordCount_--;
+}
+
+void TTFGlyphStore::compact() {
+    // Record pages left without glyphs are returned to the heap. Their slot is kept, for the
+    // indexes of the records of the next pages to stay valid.
+    for (uint32_t page = 0; page < recordPages_.size(); page++) {
+        Record *records = recordPages_[page];
+        if ((records == nullptr) ||
+            !std::all_of(records, records + RECORDS_PER_PAGE,
+                         [](const Record &rec) { return rec.key == NO_INDEX; })) {
+            continue;
+        }
+        freeRecords_.erase(std::remove_if(freeRecords_.begin(), freeRecords_.end(),
+                                          [page](Index idx) {
+                                              return (idx >> RECORDS_PER_PAGE_SHIFT) == page;
+                                          }),
+                           freeRecords_.end());
+        fontFree(records);
+        recordPages_[page] = nullptr;
+        allocatedBytes_ -= sizeof(Record) * RECORDS_PER_PAGE;
+    }
+
+#if !CONFIG_TINYFONT_TTF_CACHE_ATLAS
+    uint32_t pageIdx = 0;
+    while (pageIdx < pixelPages_.size()) {
+        PixelPage &page = pixelPages_[pageIdx];
+
+        uint32_t readPos = 0;
+        uint32_t writePos = 0;
+        while (readPos < page.used) {
+            auto header = reinterpret_cast<BlockHeader *>(page.data + readPos);
+            uint32_t blockSize = header->size;
+            if (header->owner != NO_INDEX) {
+                if (writePos != readPos) {
+                    memmove(page.data + writePos, header, blockSize);
+                    auto moved = reinterpret_cast<BlockHeader *>(page.data + writePos);
+                    record(moved->owner).glyph.bitmap.pixels =
+                        reinterpret_cast<MemoryPtr>(moved + 1);
+                }
+                writePos += blockSize;
+            }
+            readPos += blockSize;
+        }
+        page.used = writePos;
+
+        if (page.used == 0) {
+            fontFree(page.data);
+            allocatedBytes_ -= page.size;
+            pixelPages_.erase(pixelPages_.begin() + pageIdx);
+        } else {
+            pageIdx++;
+        }
+    }
+#endif
+}
+
+void TTFGlyphStore::clear() {
+#if CONFIG_TINYFONT_TTF_CACHE_ATLAS
+    atlas_.clear();
+#else
+    for (auto &page : pixelPages_) {
+        fontFree(page.data);
+    }
+    pixelPages_.clear();
+#endif
+    for (auto page : recordPages_) {
+        fontFree(page);
+    }
+    recordPages_.clear();
+    freeRecords_.clear();
+    recordCount_ = 0;
+    allocatedBytes_ = 0;
+}
+
+#endif
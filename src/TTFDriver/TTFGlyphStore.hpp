@@ -0,0 +1,146 @@
+#pragma once
+
+#if CONFIG_TINYFONT_TTF
+
+#include <vector>
+
+#include "../FontDefs.hpp"
+#include "../Misc/SpiramAllocator.hpp"
+#include "TTFAtlas.hpp"
+#include "TTFDefs.hpp"
+
+using namespace font_defs;
+
+/**
+ * @brief Slab storage for the glyphs kept in the TTFCache.
+ *
+ * Glyph records are carved out of fixed-size record pages and their bitmap pixels are
+ * bump-allocated inside large pixel pages, instead of doing a heap allocation for each
+ * one of them. Released pixel blocks are reclaimed by compact(), that slides the live
+ * blocks toward the start of their page and returns the pages left empty to the heap.
+ *
+ * With CONFIG_TINYFONT_TTF_CACHE_ATLAS, the bitmaps are instead packed in the pages of a
+ * TTFAtlas and each record keeps the location of its bitmap in the atlas.
+ *
+ * All pages come from the SPIRAM heap when CONFIG_TINYFONT_USE_SPIRAM is set.
+ */
+class TTFGlyphStore {
+public:
+    typedef uint32_t Index;
+
+    static constexpr Index NO_INDEX = 0xFFFFFFFF;
+
+    struct Record {
+        Glyph glyph;
+        uint32_t key;
+        uint32_t lastUse;
+#if CONFIG_TINYFONT_TTF_CACHE_ATLAS
+        TTFAtlas::Location location;
+#endif
+    };
+
+private:
+    static constexpr uint32_t RECORDS_PER_PAGE_SHIFT = 6;
+    static constexpr uint32_t RECORDS_PER_PAGE = 1 << RECORDS_PER_PAGE_SHIFT;
+    static constexpr uint32_t PIXEL_PAGE_SIZE = 16 * 1024;
+
+    // Each pixel block in a page is preceded by this header. The owner is the index of the
+    // record using the block, or NO_INDEX once the block has been released.
+    struct BlockHeader {
+        uint32_t size;
+        Index owner;
+    };
+
+    struct PixelPage {
+        MemoryPtr data;
+        uint32_t size;
+        uint32_t used;
+    };
+
+#if CONFIG_TINYFONT_USE_SPIRAM
+    template <typename T>
+    using StoreVector = std::vector<T, FontSpiramAllocator<T>>;
+#else
+    template <typename T>
+    using StoreVector = std::vector<T>;
+#endif
+
+    StoreVector<Record *> recordPages_;
+    StoreVector<Index> freeRecords_;
+#if CONFIG_TINYFONT_TTF_CACHE_ATLAS
+    TTFAtlas atlas_;
+#else
+    StoreVector<PixelPage> pixelPages_;
+#endif
+
+    uint32_t recordCount_{0};
+    uint32_t allocatedBytes_{0};
+    uint32_t budget_;
+
+#if CONFIG_TINYFONT_TTF_CACHE_ATLAS
+    auto allocatePixels(Record &rec, PixelResolution resolution, uint16_t width,
+                        uint16_t height) -> bool;
+#else
+    auto allocatePixels(Index owner, uint32_t size) -> MemoryPtr;
+#endif
+
+public:
+    TTFGlyphStore(uint32_t budget) : budget_(budget) {}
+
+    ~TTFGlyphStore() { clear(); }
+
+    TTFGlyphStore(const TTFGlyphStore &) = delete;
+    auto operator=(const TTFGlyphStore &) -> TTFGlyphStore & = delete;
+
+    [[nodiscard]] inline auto record(Index idx) -> Record & {
+        return recordPages_[idx >> RECORDS_PER_PAGE_SHIFT][idx & (RECORDS_PER_PAGE - 1)];
+    }
+
+    [[nodiscard]] inline auto getRecordCount() const -> uint32_t { return recordCount_; }
+    [[nodiscard]] inline auto getAllocatedBytes() const -> uint32_t { return allocatedBytes_; }
+    [[nodiscard]] inline auto getBudget() const -> uint32_t { return budget_; }
+    inline void setBudget(uint32_t budget) { budget_ = budget; }
+
+    /// @brief Add a glyph to the store
+    ///
+    /// The metrics of **glyph** are copied in a new record and its bitmap rows are copied
+    /// in the pixel pages with the smallest pitch allowed by **resolution**.
+    ///
+    /// @param key In. The cache key of the glyph.
+    /// @param glyph In. The glyph to copy. Its pixels are only read.
+    /// @param resolution In. The pixel resolution of the glyph bitmap.
+    /// @return The index of the new record or NO_INDEX if the budget has been reached.
+    ///
+    auto insert(uint32_t key, const Glyph &glyph, PixelResolution resolution) -> Index;
+
+    void release(Index idx);
+
+    /// @brief Slide live pixel blocks to the start of their page and free the empty pages,
+    /// record pages included.
+    ///
+    /// With the atlas, pixel pages are already freed as soon as their last bitmap is released.
+    void compact();
+
+#if CONFIG_TINYFONT_TTF_CACHE_ATLAS
+    [[nodiscard]] inline auto getAtlas() const -> const TTFAtlas & { return atlas_; }
+#endif
+
+    void clear();
+
+    template <typename F>
+    void forEach(F handler) {
+        for (uint32_t page = 0; page < recordPages_.size(); page++) {
+            if (recordPages_[page] == nullptr) {
+                continue;
+            }
+            for (uint32_t i = 0; i < RECORDS_PER_PAGE; i++) {
+                Record &rec = recordPages_[page][i];
+                if (rec.key != NO_INDEX) {
+                    handler((page << RECORDS_PER_PAGE_SHIFT) + i, rec);
+                }
+            }
+        }
+    }
+};
+
+#endif
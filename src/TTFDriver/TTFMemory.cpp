@@ -0,0 +1,233 @@
+#if CONFIG_TINYFONT_TTF
+
+#include "TTFMemory.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <mutex>
+
+#include "../Misc/SpiramAllocator.hpp"
+
+namespace {
+
+// Each block starts with a header, padded to keep the returned memory aligned.
+struct Header {
+    uint32_t size;
+    uint8_t sizeClass;
+    TTFMemoryPhase phase;
+};
+
+const constexpr std::size_t HEADER_SIZE = std::max<std::size_t>(alignof(std::max_align_t), 8);
+static_assert(sizeof(Header) <= HEADER_SIZE);
+
+// Slot sizes of the pools, header included. Larger blocks come from the heap.
+const constexpr std::size_t SLOT_SIZES[] = {32, 64, 128, 256, 512, 1024};
+const constexpr uint8_t CLASS_COUNT = sizeof(SLOT_SIZES) / sizeof(SLOT_SIZES[0]);
+const constexpr uint8_t HEAP_CLASS = 0xFF;
+
+const constexpr int PHASE_COUNT = static_cast<int>(TTFMemoryPhase::COUNT);
+const char *PHASE_NAMES[PHASE_COUNT] = {"other", "face open", "load glyph", "render"};
+
+struct FreeSlot {
+    FreeSlot *next;
+};
+
+FreeSlot *freeLists[CLASS_COUNT] = {};
+uint32_t poolBytes = 0;
+
+TTFMemory::Stats phaseStats[PHASE_COUNT] = {};
+TTFMemory::Stats totalStats = {};
+
+thread_local TTFMemoryPhase currentPhase = TTFMemoryPhase::OTHER;
+
+// The pools and statistics are shared by all the FontData objects, whatever task uses them.
+std::mutex mutex;
+typedef std::lock_guard<std::mutex> Lock;
+
+auto sizeClassOf([[maybe_unused]] std::size_t bytes) -> uint8_t {
+#if CONFIG_TINYFONT_TTF_MEMORY_POOL
+    for (uint8_t sizeClass = 0; sizeClass < CLASS_COUNT; sizeClass++) {
+        if (bytes <= SLOT_SIZES[sizeClass]) {
+            return sizeClass;
+        }
+    }
+#endif
+    return HEAP_CLASS;
+}
+
+auto headerOf(void *block) -> Header * {
+    return reinterpret_cast<Header *>(static_cast<uint8_t *>(block) - HEADER_SIZE);
+}
+
+void addLive(TTFMemory::Stats &stats, uint32_t size) {
+    stats.liveBytes += size;
+    stats.peakBytes = std::max(stats.peakBytes, stats.liveBytes);
+}
+
+void account(Header &header) {
+    header.phase = currentPhase;
+    addLive(phaseStats[static_cast<int>(header.phase)], header.size);
+    addLive(totalStats, header.size);
+    phaseStats[static_cast<int>(header.phase)].allocCount++;
+    totalStats.allocCount++;
+}
+
+void unaccount(const Header &header) {
+    phaseStats[static_cast<int>(header.phase)].liveBytes -= header.size;
+    totalStats.liveBytes -= header.size;
+}
+
+// Carve a new chunk in slots of a size class.
+auto refill(uint8_t sizeClass) -> bool {
+    std::size_t slotSize = SLOT_SIZES[sizeClass];
+    std::size_t count =
+        std::max<std::size_t>(1, CONFIG_TINYFONT_TTF_MEMORY_CHUNK_SIZE / slotSize);
+
+    auto chunk = static_cast<uint8_t *>(fontMalloc(slotSize * count));
+    if (chunk == nullptr) {
+        return false;
+    }
+    poolBytes += slotSize * count;
+
+    for (std::size_t i = count; i > 0; i--) {
+        auto slot = reinterpret_cast<FreeSlot *>(chunk + (i - 1) * slotSize);
+        slot->next = freeLists[sizeClass];
+        freeLists[sizeClass] = slot;
+    }
+    return true;
+}
+
+auto allocate(std::size_t size) -> void * {
+    uint8_t sizeClass = sizeClassOf(HEADER_SIZE + size);
+
+    void *block;
+    if (sizeClass == HEAP_CLASS) {
+        block = fontMalloc(HEADER_SIZE + size);
+    } else {
+        if ((freeLists[sizeClass] == nullptr) && !refill(sizeClass)) {
+            return nullptr;
+        }
+        block = freeLists[sizeClass];
+        freeLists[sizeClass] = freeLists[sizeClass]->next;
+    }
+    if (block == nullptr) {
+        return nullptr;
+    }
+
+    auto header = static_cast<Header *>(block);
+    header->size = static_cast<uint32_t>(size);
+    header->sizeClass = sizeClass;
+    account(*header);
+
+    return static_cast<uint8_t *>(block) + HEADER_SIZE;
+}
+
+void release(void *block) {
+    Header *header = headerOf(block);
+    unaccount(*header);
+
+    uint8_t sizeClass = header->sizeClass;
+    if (sizeClass == HEAP_CLASS) {
+        fontFree(header);
+    } else {
+        // The link overwrites the header
+        auto slot = reinterpret_cast<FreeSlot *>(header);
+        slot->next = freeLists[sizeClass];
+        freeLists[sizeClass] = slot;
+    }
+}
+
+auto ftAlloc(FT_Memory, long size) -> void * {
+    Lock lock(mutex);
+    return allocate(static_cast<std::size_t>(size));
+}
+
+void ftFree(FT_Memory, void *block) {
+    Lock lock(mutex);
+    release(block);
+}
+
+auto ftRealloc(FT_Memory, long, long newSize, void *block) -> void * {
+    Lock lock(mutex);
+
+    if (block == nullptr) {
+        return allocate(static_cast<std::size_t>(newSize));
+    }
+
+    Header *header = headerOf(block);
+    uint8_t sizeClass = sizeClassOf(HEADER_SIZE + static_cast<std::size_t>(newSize));
+
+    if ((sizeClass == header->sizeClass) && (sizeClass != HEAP_CLASS)) {
+        // Still fits in its slot
+        unaccount(*header);
+        header->size = static_cast<uint32_t>(newSize);
+        account(*header);
+        return block;
+    }
+
+    void *newBlock = allocate(static_cast<std::size_t>(newSize));
+    if (newBlock == nullptr) {
+        return nullptr;
+    }
+    memcpy(newBlock, block, std::min<std::size_t>(header->size, static_cast<std::size_t>(newSize)));
+    release(block);
+    return newBlock;
+}
+
+FT_MemoryRec_ ftMemory = {
+    nullptr,
+    ftAlloc,
+    ftFree,
+    ftRealloc,
+};
+
+} // namespace
+
+auto TTFMemory::getMemory() -> FT_Memory { return &ftMemory; }
+
+auto TTFMemory::setPhase(TTFMemoryPhase phase) -> TTFMemoryPhase {
+    TTFMemoryPhase previous = currentPhase;
+    currentPhase = phase;
+    return previous;
+}
+
+auto TTFMemory::getStats(TTFMemoryPhase phase) -> Stats {
+    Lock lock(mutex);
+    return phaseStats[static_cast<int>(phase)];
+}
+
+auto TTFMemory::getTotalStats() -> Stats {
+    Lock lock(mutex);
+    return totalStats;
+}
+
+auto TTFMemory::getPoolBytes() -> uint32_t {
+    Lock lock(mutex);
+    return poolBytes;
+}
+
+void TTFMemory::resetStats() {
+    Lock lock(mutex);
+    for (Stats &stats : phaseStats) {
+        stats.peakBytes = stats.liveBytes;
+        stats.allocCount = 0;
+    }
+    totalStats.peakBytes = totalStats.liveBytes;
+    totalStats.allocCount = 0;
+}
+
+void TTFMemory::showStats() {
+    Lock lock(mutex);
+    for (int phase = 0; phase < PHASE_COUNT; phase++) {
+        LOGI("FreeType memory, %s: live: %" PRIu32 " bytes, peak: %" PRIu32
+             " bytes, allocations: %" PRIu32 ".",
+             PHASE_NAMES[phase], phaseStats[phase].liveBytes, phaseStats[phase].peakBytes,
+             phaseStats[phase].allocCount);
+    }
+    LOGI("FreeType memory, total: live: %" PRIu32 " bytes, peak: %" PRIu32
+         " bytes, allocations: %" PRIu32 ", pools: %" PRIu32 " bytes.",
+         totalStats.liveBytes, totalStats.peakBytes, totalStats.allocCount, poolBytes);
+}
+
+#endif
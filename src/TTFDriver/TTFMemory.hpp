@@ -0,0 +1,68 @@
+#pragma once
+
+#if CONFIG_TINYFONT_TTF
+
+#include "../FontDefs.hpp"
+#include "TTFDefs.hpp"
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+/// @brief What FreeType is doing when it allocates memory, for the accounting of TTFMemory.
+enum class TTFMemoryPhase : uint8_t { OTHER, FACE_OPEN, LOAD_GLYPH, RENDER, COUNT };
+
+/**
+ * @brief The FreeType memory manager.
+ *
+ * Loading and rendering a glyph makes many small, short-lived allocations. With
+ * CONFIG_TINYFONT_TTF_MEMORY_POOL set, blocks up to 1 KB come from size-class free lists
+ * carved in chunks of CONFIG_TINYFONT_TTF_MEMORY_CHUNK_SIZE bytes, instead of being
+ * scattered all over the heap. The chunks are kept for reuse, never returned to the heap.
+ * Larger blocks come from the heap (see fontMalloc()).
+ *
+ * Every allocation is accounted to the phase set by the innermost TTFMemoryPhaseGuard of the
+ * allocating thread: live bytes, peak of the live bytes and number of allocations.
+ */
+class TTFMemory {
+public:
+    struct Stats {
+        uint32_t liveBytes;
+        uint32_t peakBytes;
+        uint32_t allocCount;
+    };
+
+    /// @brief The memory manager given to FT_New_Library().
+    [[nodiscard]] static auto getMemory() -> FT_Memory;
+
+    /// @brief Set the phase of the calling thread, returning the previous one.
+    static auto setPhase(TTFMemoryPhase phase) -> TTFMemoryPhase;
+
+    /// @brief Accounting of the blocks allocated during **phase**.
+    [[nodiscard]] static auto getStats(TTFMemoryPhase phase) -> Stats;
+
+    /// @brief Accounting of all the blocks.
+    [[nodiscard]] static auto getTotalStats() -> Stats;
+
+    /// @brief Bytes of the chunks reserved by the size-class pools.
+    [[nodiscard]] static auto getPoolBytes() -> uint32_t;
+
+    /// @brief Restart the peaks and allocation counts from now on.
+    static void resetStats();
+
+    static void showStats();
+};
+
+/// @brief Accounts the FreeType allocations of the current thread to **phase** until
+/// destroyed.
+class TTFMemoryPhaseGuard {
+    TTFMemoryPhase previous_;
+
+public:
+    explicit TTFMemoryPhaseGuard(TTFMemoryPhase phase) : previous_(TTFMemory::setPhase(phase)) {}
+    ~TTFMemoryPhaseGuard() { TTFMemory::setPhase(previous_); }
+
+    TTFMemoryPhaseGuard(const TTFMemoryPhaseGuard &) = delete;
+    auto operator=(const TTFMemoryPhaseGuard &) -> TTFMemoryPhaseGuard & = delete;
+};
+
+#endif
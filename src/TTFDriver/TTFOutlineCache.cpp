@@ -0,0 +1,96 @@
+#if CONFIG_TINYFONT_TTF
+
+#include "TTFOutlineCache.hpp"
+
+#include <vector>
+
+auto TTFOutlineCache::get(FT_Face face, GlyphCode glyphCode) -> FT_OutlineGlyph {
+
+    if (budget_ == 0) {
+        return nullptr;
+    }
+
+    if (Entry *entry = outlines_.find(glyphCode); entry != nullptr) {
+        hitCount_++;
+        entry->lastUse = ++useTick_;
+        return entry->glyph;
+    }
+
+    missCount_++;
+
+    GlyphCode theGlyphCode = (glyphCode >= 0x8000) ? glyphCode - 0x8000 : glyphCode;
+    if ((FT_Load_Glyph(face, theGlyphCode, FT_LOAD_NO_SCALE) != 0) ||
+        (face->glyph->format != FT_GLYPH_FORMAT_OUTLINE)) {
+        return nullptr;
+    }
+
+    FT_Glyph glyph;
+    if (FT_Get_Glyph(face->glyph, &glyph) != 0) {
+        LOGE("Unable to retrieve the outline of glyph: %d", theGlyphCode);
+        return nullptr;
+    }
+
+    auto outlineGlyph = reinterpret_cast<FT_OutlineGlyph>(glyph);
+    const FT_Outline &outline = outlineGlyph->outline;
+    auto bytes = static_cast<uint32_t>(sizeof(FT_OutlineGlyphRec) +
+                                       outline.n_points * (sizeof(FT_Vector) + sizeof(char)) +
+                                       outline.n_contours * sizeof(short));
+
+    while ((allocatedBytes_ + bytes > budget_) && (outlines_.size() > 0)) {
+        evict();
+    }
+    if ((allocatedBytes_ + bytes > budget_) ||
+        !outlines_.insert(glyphCode, Entry{outlineGlyph, bytes, ++useTick_})) {
+        // Larger than the whole budget: the glyph is loaded the usual way
+        FT_Done_Glyph(glyph);
+        return nullptr;
+    }
+
+    allocatedBytes_ += bytes;
+    return outlineGlyph;
+}
+
+void TTFOutlineCache::evict() {
+    uint32_t oldest = useTick_;
+    outlines_.forEach([&oldest](uint32_t, const Entry &entry) {
+        if (entry.lastUse < oldest) {
+            oldest = entry.lastUse;
+        }
+    });
+
+    // Everything used before the middle of the oldest-to-newest span is released.
+    uint32_t limit = oldest + ((useTick_ - oldest) >> 1) + 1;
+
+    // Keys are collected first, as erasing shifts the entries of the table.
+    std::vector<uint32_t> victims;
+    outlines_.forEach([limit, &victims](uint32_t key, const Entry &entry) {
+        if (entry.lastUse < limit) {
+            victims.push_back(key);
+        }
+    });
+
+    for (uint32_t key : victims) {
+        Entry *entry = outlines_.find(key);
+        allocatedBytes_ -= entry->bytes;
+        FT_Done_Glyph(reinterpret_cast<FT_Glyph>(entry->glyph));
+        outlines_.erase(key);
+        evictCount_++;
+    }
+}
+
+void TTFOutlineCache::clear() {
+    outlines_.forEach([](uint32_t, Entry &entry) {
+        FT_Done_Glyph(reinterpret_cast<FT_Glyph>(entry.glyph));
+    });
+    outlines_.reset();
+    allocatedBytes_ = 0;
+    hitCount_ = missCount_ = evictCount_ = 0;
+}
+
+void TTFOutlineCache::showStats() const {
+    LOGI("Outlines' cache statistics: hits: %" PRIu32 ", misses: %" PRIu32
+         ", evictions: %" PRIu32 ", memory: %" PRIu32 " bytes.",
+         hitCount_, missCount_, evictCount_, allocatedBytes_);
+}
+
+#endif
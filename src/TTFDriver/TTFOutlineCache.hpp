@@ -0,0 +1,88 @@
+#pragma once
+
+#if CONFIG_TINYFONT_TTF
+
+#include "../FontDefs.hpp"
+#include "../Misc/FlatHashMap.hpp"
+#include "TTFDefs.hpp"
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include FT_GLYPH_H
+
+using namespace font_defs;
+
+/**
+ * @brief Cache of the unscaled glyph outlines of a font.
+ *
+ * Outlines are kept in font units, as loaded with FT_LOAD_NO_SCALE: they serve all sizes.
+ * A glyph missing from the TTFCache at a new size is then only scaled and rasterized, the
+ * glyph tables being neither searched nor decoded again. As the hinting instructions are
+ * not run on them, these glyphs are rendered unhinted.
+ *
+ * The cache is disabled while its budget is 0. Over budget, the least recently used half
+ * of the outlines is released.
+ */
+class TTFOutlineCache {
+    struct Entry {
+        FT_OutlineGlyph glyph;
+        uint32_t bytes;
+        uint32_t lastUse;
+    };
+
+    FlatHashMap<Entry> outlines_;
+    uint32_t budget_{CONFIG_TINYFONT_TTF_OUTLINE_CACHE_SIZE * 1024};
+    uint32_t allocatedBytes_{0};
+
+    uint32_t hitCount_{0};
+    uint32_t missCount_{0};
+    uint32_t evictCount_{0};
+    uint32_t useTick_{0};
+
+    // Release the least recently used half of the outlines.
+    void evict();
+
+public:
+    TTFOutlineCache() = default;
+
+    ~TTFOutlineCache() {
+        if (budget_ > 0) {
+            showStats();
+        }
+        clear();
+    }
+
+    TTFOutlineCache(const TTFOutlineCache &) = delete;
+    auto operator=(const TTFOutlineCache &) -> TTFOutlineCache & = delete;
+
+    /// @brief Retrieve the unscaled outline of a glyph, loading it from **face** on a miss
+    ///
+    /// The outline stays valid until the next call: it must be copied to be scaled.
+    ///
+    /// @param face In. The face the glyph belongs to.
+    /// @param glyphCode In. The glyph code, 0x8000 being set for the private face glyphs.
+    /// @return The outline, or nullptr if the cache is disabled or the glyph has no outline.
+    ///
+    auto get(FT_Face face, GlyphCode glyphCode) -> FT_OutlineGlyph;
+
+    /// @brief Set the memory budget of the cache, in bytes. 0 disables the cache.
+    inline void setBudget(uint32_t bytes) {
+        budget_ = bytes;
+        while ((allocatedBytes_ > budget_) && (outlines_.size() > 0)) {
+            evict();
+        }
+    }
+
+    [[nodiscard]] inline auto getBudget() const -> uint32_t { return budget_; }
+    [[nodiscard]] inline auto isEnabled() const -> bool { return budget_ > 0; }
+    [[nodiscard]] inline auto getAllocatedBytes() const -> uint32_t { return allocatedBytes_; }
+    [[nodiscard]] inline auto getOutlineCount() const -> uint32_t { return outlines_.size(); }
+    [[nodiscard]] inline auto getHitCount() const -> uint32_t { return hitCount_; }
+    [[nodiscard]] inline auto getMissCount() const -> uint32_t { return missCount_; }
+    [[nodiscard]] inline auto getEvictCount() const -> uint32_t { return evictCount_; }
+
+    void clear();
+    void showStats() const;
+};
+
+#endif
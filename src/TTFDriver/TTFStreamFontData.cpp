@@ -0,0 +1,77 @@
+#if CONFIG_TINYFONT_TTF
+
+#include "TTFStreamFontData.hpp"
+
+#include <algorithm>
+
+#include "../Misc/FNVHash.hpp"
+
+TTFStreamFontData::TTFStreamFontData(const char *path, const char *privatePath,
+                                     uint32_t blockSize, uint32_t blockCount)
+    : stream_(blockSize, blockCount) {
+    if (!stream_.open(path)) {
+        LOGE("Unable to stream TTF font file %s.", path);
+    }
+    setup(privatePath);
+}
+
+#if defined(ESP_PLATFORM)
+TTFStreamFontData::TTFStreamFontData(const esp_partition_t *partition, const char *privatePath,
+                                     uint32_t blockSize, uint32_t blockCount)
+    : stream_(blockSize, blockCount) {
+    if (!stream_.open(partition)) {
+        LOGE("Unable to stream the TTF font partition.");
+    }
+    setup(privatePath);
+}
+#endif
+
+void TTFStreamFontData::setup(const char *privatePath) {
+    if ((privatePath != nullptr) && !privateFile_.open(privatePath)) {
+        LOGE("Unable to map TTF private font file %s.", privatePath);
+    }
+
+    if (!stream_.isOpen()) {
+        return;
+    }
+
+    // Offset table: sfnt version (4 bytes), table count (2 bytes) and 6 bytes of search
+    // hints, then 16 bytes per table: tag, checksum, offset and length.
+    uint8_t directory[12 + 16 * 64];
+    uint32_t length = stream_.read(0, directory, 12);
+    if (length == 12) {
+        uint32_t tableCount = std::min((directory[4] << 8) | directory[5], 64);
+        length += stream_.read(12, directory + 12, 16 * tableCount);
+    }
+
+    uint32_t hash = fnv1a(directory, length);
+    if (getPrivateData() != nullptr) {
+        hash = fnv1a(getPrivateData(), getPrivateDataSize(), hash);
+    }
+    dataHash_ = (hash == 0) ? 1 : hash;
+
+    // Only the reads of FreeType are accounted
+    stream_.resetStats();
+}
+
+auto TTFStreamFontData::openMainFace(FT_Face &face) -> bool {
+    if (!stream_.isOpen()) {
+        return false;
+    }
+
+    FT_Open_Args args{};
+    args.flags = FT_OPEN_STREAM;
+    args.stream = stream_.getStream();
+
+    int error = FT_Open_Face(getLibrary(), &args, 0, &face);
+    if (error) {
+        LOGE("The streamed font format is unsupported or is broken (%d).", error);
+        face = nullptr;
+        return false;
+    }
+    return true;
+}
+
+auto TTFStreamFontData::getDataHash() const -> uint32_t { return dataHash_; }
+
+#endif
@@ -0,0 +1,74 @@
+#pragma once
+
+#if CONFIG_TINYFONT_TTF
+
+#include "../Misc/MappedFile.hpp"
+#include "TTFBlockStream.hpp"
+#include "TTFFontData.hpp"
+
+/**
+ * @brief TTF font data streamed from a font file or a flash partition.
+ *
+ * For fonts too large to be kept in memory, such as CJK fonts: FreeType reads the main
+ * font through a TTFBlockStream, only the blocks of the tables and glyphs in use being in
+ * memory. The small private font is mapped as a whole (see MappedFile).
+ *
+ * As with TTFFileFontData, kerning comes from the 'kern' table of the main font, if any.
+ * There is no ligature.
+ */
+class TTFStreamFontData : public FontData {
+    TTFBlockStream stream_;
+    MappedFile privateFile_{};
+    uint32_t dataHash_{0};
+
+    // Hash the table directory and map the private font, once the stream is opened.
+    void setup(const char *privatePath);
+
+protected:
+    auto openMainFace(FT_Face &face) -> bool override;
+
+public:
+    /// @brief Stream **path**, and map **privatePath** for the private-use code points.
+    explicit TTFStreamFontData(const char *path, const char *privatePath = nullptr,
+                               uint32_t blockSize = CONFIG_TINYFONT_TTF_STREAM_BLOCK_SIZE,
+                               uint32_t blockCount = CONFIG_TINYFONT_TTF_STREAM_BLOCK_COUNT);
+
+#if defined(ESP_PLATFORM)
+    /// @brief Stream the font stored from the start of **partition**.
+    explicit TTFStreamFontData(const esp_partition_t *partition, const char *privatePath = nullptr,
+                               uint32_t blockSize = CONFIG_TINYFONT_TTF_STREAM_BLOCK_SIZE,
+                               uint32_t blockCount = CONFIG_TINYFONT_TTF_STREAM_BLOCK_COUNT);
+#endif
+
+    // The faces read the stream until done
+    ~TTFStreamFontData() override { closeFaces(); }
+
+    /// @brief True if the main font source is opened.
+    [[nodiscard]] inline auto isOpen() const -> bool { return stream_.isOpen(); }
+
+    /// @brief The block stream, for its statistics.
+    [[nodiscard]] inline auto getBlockStream() const -> const TTFBlockStream & { return stream_; }
+
+    auto ligKern(const GlyphCode glyphCode1, GlyphCode *glyphCode2, FIX16 *kern) const
+        -> bool override {
+        return faceKern(glyphCode1, glyphCode2, kern);
+    }
+
+    // The main font is not in memory
+    [[nodiscard]] auto getData() const -> MemoryPtr override { return nullptr; }
+    [[nodiscard]] auto getDataSize() const -> int override {
+        return static_cast<int>(stream_.getSize());
+    }
+
+    [[nodiscard]] auto getPrivateData() const -> MemoryPtr override {
+        return privateFile_.data();
+    }
+    [[nodiscard]] auto getPrivateDataSize() const -> int override {
+        return static_cast<int>(privateFile_.size());
+    }
+
+    /// @brief Hash of the font's table directory, which holds the checksum of every table.
+    [[nodiscard]] auto getDataHash() const -> uint32_t override;
+};
+
+#endif
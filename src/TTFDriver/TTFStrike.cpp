@@ -0,0 +1,218 @@
+#if CONFIG_TINYFONT_TTF
+
+#include "TTFStrike.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// Binary search of **key** in **entries**, sorted on **field**.
+template <typename T, typename K>
+auto findEntry(const T *entries, uint32_t count, K key, K T::*field) -> const T * {
+    const T *end = entries + count;
+    const T *entry = std::lower_bound(
+        entries, end, key, [field](const T &item, K value) { return item.*field < value; });
+    return ((entry != end) && (entry->*field == key)) ? entry : nullptr;
+}
+
+} // namespace
+
+auto TTFStrike::isInside(uint32_t offset, uint32_t count, uint32_t itemSize) const -> bool {
+    return ((offset & 3) == 0) && (offset <= size_) &&
+           (static_cast<uint64_t>(count) * itemSize <= size_ - offset);
+}
+
+auto TTFStrike::load(const uint8_t *data, uint32_t size) -> bool {
+    header_ = nullptr;
+    data_ = data;
+    size_ = size;
+
+    // The tables are read in place
+    if ((data == nullptr) || ((reinterpret_cast<uintptr_t>(data) & 3) != 0)) {
+        LOGE("The strike is missing or not 4 bytes aligned.");
+        return false;
+    }
+
+    auto header = reinterpret_cast<const Header *>(data);
+    if ((size < sizeof(Header)) || (memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0) ||
+        (header->version != VERSION)) {
+        LOGE("Strike not recognized.");
+        return false;
+    }
+    if (header->dpi != SCREEN_RES_PER_INCH) {
+        LOGE("The strike was rendered for %d DPI, the display is %d DPI.", header->dpi,
+             SCREEN_RES_PER_INCH);
+        return false;
+    }
+
+    if (!isInside(header->cmapOffset, header->cmapCount, sizeof(CmapEntry)) ||
+        !isInside(header->ligatureOffset, header->ligatureCount, sizeof(Ligature)) ||
+        !isInside(header->sizeOffset, header->sizeCount, sizeof(SizeEntry))) {
+        LOGE("Strike tables out of bounds.");
+        return false;
+    }
+
+    auto sizes = table<SizeEntry>(header->sizeOffset);
+    for (uint32_t i = 0; i < header->sizeCount; i++) {
+        bool valid = isInside(sizes[i].kernOffset, sizes[i].kernCount, sizeof(Kern));
+        for (const GlyphTable &glyphs : sizes[i].glyphs) {
+            valid = valid && isInside(glyphs.offset, glyphs.count, sizeof(GlyphEntry));
+        }
+        if (!valid) {
+            LOGE("Strike tables of size %d out of bounds.", sizes[i].ptSize);
+            return false;
+        }
+    }
+
+    header_ = header;
+    return true;
+}
+
+auto TTFStrike::findSize(int ptSize) const -> const SizeEntry * {
+    if (!isLoaded() || (ptSize <= 0) || (ptSize > 0xFFFF)) {
+        return nullptr;
+    }
+    return findEntry(table<SizeEntry>(header_->sizeOffset), header_->sizeCount,
+                     static_cast<uint16_t>(ptSize), &SizeEntry::ptSize);
+}
+
+auto TTFStrike::translate(char32_t codePoint) const -> GlyphCode {
+    const CmapEntry *entry = findEntry(table<CmapEntry>(header_->cmapOffset), header_->cmapCount,
+                                       static_cast<uint32_t>(codePoint), &CmapEntry::codePoint);
+    return (entry != nullptr) ? entry->glyphCode : 0;
+}
+
+auto TTFStrike::ligKern(const SizeEntry &size, GlyphCode glyphCode1, GlyphCode *glyphCode2,
+                        FIX16 *kern) const -> bool {
+    *kern = 0;
+
+    uint32_t pair = (static_cast<uint32_t>(glyphCode1) << 16) | *glyphCode2;
+
+    const Ligature *ligature = findEntry(table<Ligature>(header_->ligatureOffset),
+                                         header_->ligatureCount, pair, &Ligature::pair);
+    if (ligature != nullptr) {
+        *glyphCode2 = ligature->glyphCode;
+        return true;
+    }
+
+    const Kern *entry = findEntry(table<Kern>(size.kernOffset), size.kernCount, pair, &Kern::pair);
+    if (entry != nullptr) {
+        *kern = entry->kern;
+    }
+    return false;
+}
+
+auto TTFStrike::findGlyph(const SizeEntry &size, PixelResolution resolution,
+                          GlyphCode glyphCode) const -> const GlyphEntry * {
+    int index = resolutionIndex(resolution);
+    if (index < 0) {
+        return nullptr;
+    }
+    const GlyphTable &glyphs = size.glyphs[index];
+    return findEntry(table<GlyphEntry>(glyphs.offset), glyphs.count, glyphCode,
+                     &GlyphEntry::glyphCode);
+}
+
+auto TTFStrike::getGlyph(const SizeEntry &size, PixelResolution resolution, GlyphCode glyphCode,
+                         Glyph &glyph, std::vector<uint8_t> &pixels) const -> bool {
+
+    const GlyphEntry *entry = findGlyph(size, resolution, glyphCode);
+    if (entry == nullptr) {
+        return false;
+    }
+
+    glyph.clear();
+    glyph.metrics = {.xoff = entry->xoff,
+                     .yoff = entry->yoff,
+                     .descent = entry->descent,
+                     .advance = entry->advance,
+                     .lineHeight = size.lineHeight};
+    glyph.bitmap.dim = Dim(entry->width, entry->height);
+    glyph.bitmap.pitch = rowBytes(entry->width, resolution);
+
+    uint32_t length = static_cast<uint32_t>(glyph.bitmap.pitch) * entry->height;
+    if (length > 0) {
+        pixels.resize(length);
+        if ((entry->dataOffset > size_) || (entry->dataLength > size_ - entry->dataOffset) ||
+            !unpackBits(data_ + entry->dataOffset, entry->dataLength, pixels.data(), length)) {
+            LOGE("Corrupted strike bitmap for glyph: %d", glyphCode);
+            return false;
+        }
+        glyph.bitmap.pixels = pixels.data();
+    }
+    return true;
+}
+
+auto TTFStrike::getMeasure(const SizeEntry &size, PixelResolution resolution,
+                           GlyphCode glyphCode, TTFCache::Measure &measure) const -> bool {
+
+    const GlyphEntry *entry = findGlyph(size, resolution, glyphCode);
+    if (entry == nullptr) {
+        return false;
+    }
+
+    measure.metrics = {.xoff = entry->xoff,
+                       .yoff = entry->yoff,
+                       .descent = entry->descent,
+                       .advance = entry->advance,
+                       .lineHeight = size.lineHeight};
+    measure.width = entry->width;
+    return true;
+}
+
+void TTFStrike::packBits(const uint8_t *bytes, uint32_t length, std::vector<uint8_t> &out) {
+    uint32_t i = 0;
+    while (i < length) {
+        uint32_t run = 1;
+        while ((i + run < length) && (run < 130) && (bytes[i + run] == bytes[i])) {
+            run++;
+        }
+        if (run >= 3) {
+            out.push_back(static_cast<uint8_t>(run + 125));
+            out.push_back(bytes[i]);
+            i += run;
+            continue;
+        }
+
+        // Literals, up to the next run of 3 identical bytes
+        uint32_t start = i;
+        while ((i < length) && (i - start < 128)) {
+            if ((i + 2 < length) && (bytes[i] == bytes[i + 1]) && (bytes[i] == bytes[i + 2])) {
+                break;
+            }
+            i++;
+        }
+        out.push_back(static_cast<uint8_t>(i - start - 1));
+        out.insert(out.end(), bytes + start, bytes + i);
+    }
+}
+
+auto TTFStrike::unpackBits(const uint8_t *packed, uint32_t packedLength, uint8_t *bytes,
+                           uint32_t length) -> bool {
+    const uint8_t *end = packed + packedLength;
+    uint32_t done = 0;
+
+    while ((packed < end) && (done < length)) {
+        uint8_t control = *packed++;
+        if (control < 128) {
+            uint32_t count = control + 1;
+            if ((count > static_cast<uint32_t>(end - packed)) || (count > length - done)) {
+                return false;
+            }
+            memcpy(bytes + done, packed, count);
+            packed += count;
+            done += count;
+        } else {
+            uint32_t count = control - 125;
+            if ((packed == end) || (count > length - done)) {
+                return false;
+            }
+            memset(bytes + done, *packed++, count);
+            done += count;
+        }
+    }
+    return (done == length) && (packed == end);
+}
+
+#endif
@@ -0,0 +1,167 @@
+#pragma once
+
+#if CONFIG_TINYFONT_TTF
+
+#include <vector>
+
+#include "../FontDefs.hpp"
+#include "TTFCache.hpp"
+#include "TTFDefs.hpp"
+
+using namespace ttf_defs;
+using namespace font_defs;
+
+/**
+ * @brief Reader of pre-rasterized bitmap strikes.
+ *
+ * A strike holds, for a few point sizes, everything a Font needs to draw text without
+ * FreeType: the code point to glyph code map, the ligatures, the kerning pairs scaled to
+ * each size, and the glyph bitmaps rendered by Font::getGlyphForCache() for the 8 bits
+ * and/or 1 bit font pixel resolutions. Strikes are built on a host with TTFStrikeWriter
+ * (see tools/ttf_strike) for the display resolution of the device.
+ *
+ * The strike is used in place, from a font header array or a mapped file. The bitmaps are
+ * unpacked in the glyphs' cache when first drawn.
+ *
+ * Layout: all values are little-endian and 4 bytes aligned, offsets being from the start
+ * of the strike. A Header is followed by the tables it points to: CmapEntry sorted by code
+ * point, Ligature sorted by glyph pair, then one SizeEntry per point size, sorted by size,
+ * each one pointing to its Kern pairs and, for each resolution, to its GlyphEntry sorted
+ * by glyph code. A GlyphEntry points to its bitmap rows, packed with packBits().
+ */
+class TTFStrike {
+public:
+    static constexpr char MAGIC[4] = {'T', 'F', 'S', 'K'};
+    static constexpr uint16_t VERSION = 1;
+
+    struct Header {
+        char magic[4];
+        uint16_t version;
+        uint16_t dpi; // Display resolution the glyphs were rendered for
+        uint32_t fontHash;
+        uint32_t cmapCount, cmapOffset;
+        uint32_t ligatureCount, ligatureOffset;
+        uint32_t sizeCount, sizeOffset;
+    };
+
+    struct CmapEntry {
+        uint32_t codePoint;
+        GlyphCode glyphCode;
+        uint16_t reserved;
+    };
+
+    struct Ligature {
+        uint32_t pair; // First glyph code in the 16 upper bits
+        GlyphCode glyphCode;
+        uint16_t reserved;
+    };
+
+    struct Kern {
+        uint32_t pair;
+        FIX16 kern;
+        uint16_t reserved;
+    };
+
+    struct GlyphEntry {
+        GlyphCode glyphCode;
+        uint16_t width, height;
+        FIX16 advance;
+        int16_t xoff, yoff, descent;
+        uint16_t reserved;
+        uint32_t dataOffset, dataLength;
+    };
+
+    struct GlyphTable {
+        uint32_t count, offset;
+    };
+
+    // Glyph tables of the 8 bits and 1 bit font pixel resolutions, in this order
+    static constexpr int RESOLUTION_COUNT = 2;
+
+    struct SizeEntry {
+        uint16_t ptSize;
+        int16_t lineHeight;
+        int16_t descender;
+        FIX16 spaceSize;
+        uint32_t kernCount, kernOffset;
+        GlyphTable glyphs[RESOLUTION_COUNT];
+    };
+
+    static_assert(sizeof(Header) == 36);
+    static_assert(sizeof(CmapEntry) == 8);
+    static_assert(sizeof(Ligature) == 8);
+    static_assert(sizeof(Kern) == 8);
+    static_assert(sizeof(GlyphEntry) == 24);
+    static_assert(sizeof(SizeEntry) == 32);
+
+private:
+    const uint8_t *data_{nullptr};
+    uint32_t size_{0};
+    const Header *header_{nullptr};
+
+    template <typename T>
+    [[nodiscard]] inline auto table(uint32_t offset) const -> const T * {
+        return reinterpret_cast<const T *>(data_ + offset);
+    }
+
+    [[nodiscard]] auto isInside(uint32_t offset, uint32_t count, uint32_t itemSize) const -> bool;
+
+    [[nodiscard]] auto findGlyph(const SizeEntry &size, PixelResolution resolution,
+                                 GlyphCode glyphCode) const -> const GlyphEntry *;
+
+public:
+    TTFStrike() = default;
+
+    /// @brief Use the strike at **data**, that must stay available while in use.
+    /// @return false if the strike is not valid or not for the display resolution in use.
+    auto load(const uint8_t *data, uint32_t size) -> bool;
+
+    [[nodiscard]] inline auto isLoaded() const -> bool { return header_ != nullptr; }
+
+    [[nodiscard]] inline auto getFontHash() const -> uint32_t {
+        return isLoaded() ? header_->fontHash : 0;
+    }
+
+    /// @brief The entry of **ptSize**, nullptr if the strike does not have it.
+    [[nodiscard]] auto findSize(int ptSize) const -> const SizeEntry *;
+
+    /// @brief The glyph code of **codePoint**, 0 if not in the strike.
+    [[nodiscard]] auto translate(char32_t codePoint) const -> GlyphCode;
+
+    /// @brief Same as FontData::ligKern(), the kerning being already scaled to **size**.
+    auto ligKern(const SizeEntry &size, GlyphCode glyphCode1, GlyphCode *glyphCode2,
+                 FIX16 *kern) const -> bool;
+
+    /// @brief Unpack a glyph bitmap into **pixels**, **glyph** pointing to them.
+    auto getGlyph(const SizeEntry &size, PixelResolution resolution, GlyphCode glyphCode,
+                  Glyph &glyph, std::vector<uint8_t> &pixels) const -> bool;
+
+    /// @brief The metrics of a glyph, without unpacking its bitmap.
+    auto getMeasure(const SizeEntry &size, PixelResolution resolution, GlyphCode glyphCode,
+                    TTFCache::Measure &measure) const -> bool;
+
+    /// @brief Append **bytes** to **out**, runs of 3 to 130 identical bytes being packed.
+    ///
+    /// A control byte **c** below 128 is followed by **c** + 1 literal bytes. Otherwise the
+    /// next byte is repeated **c** - 125 times.
+    static void packBits(const uint8_t *bytes, uint32_t length, std::vector<uint8_t> &out);
+
+    /// @brief Unpack exactly **length** bytes of **packed** into **bytes**.
+    static auto unpackBits(const uint8_t *packed, uint32_t packedLength, uint8_t *bytes,
+                           uint32_t length) -> bool;
+
+    /// @brief Bytes per row of a glyph bitmap **width** pixels wide.
+    [[nodiscard]] static inline auto rowBytes(uint16_t width, PixelResolution resolution)
+        -> uint16_t {
+        return (resolution == PixelResolution::ONE_BIT) ? (width + 7) >> 3 : width;
+    }
+
+    /// @brief Index of **resolution** in SizeEntry::glyphs, -1 if strikes do not hold it.
+    [[nodiscard]] static inline auto resolutionIndex(PixelResolution resolution) -> int {
+        return (resolution == PixelResolution::EIGHT_BITS) ? 0
+               : (resolution == PixelResolution::ONE_BIT)  ? 1
+                                                           : -1;
+    }
+};
+
+#endif
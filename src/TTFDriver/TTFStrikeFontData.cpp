@@ -0,0 +1,21 @@
+#if CONFIG_TINYFONT_TTF
+
+#include "TTFStrikeFontData.hpp"
+
+TTFStrikeFontData::TTFStrikeFontData(const char *path) {
+    if (!file_.open(path)) {
+        LOGE("Unable to map TTF strike file %s.", path);
+        return;
+    }
+    if (!strike_.load(file_.data(), static_cast<uint32_t>(file_.size()))) {
+        LOGE("TTF strike file %s is not usable.", path);
+    }
+}
+
+TTFStrikeFontData::TTFStrikeFontData(const uint8_t *data, uint32_t size) {
+    if (!strike_.load(data, size)) {
+        LOGE("TTF strike is not usable.");
+    }
+}
+
+#endif
@@ -0,0 +1,54 @@
+#pragma once
+
+#if CONFIG_TINYFONT_TTF
+
+#include "../Misc/MappedFile.hpp"
+#include "TTFFontData.hpp"
+#include "TTFStrike.hpp"
+
+/**
+ * @brief TTF font data made of a pre-rasterized strike only (see TTFStrike).
+ *
+ * Fonts of the point sizes in the strike draw their glyphs from it, without opening any
+ * FreeType face. As there is no font file, Fonts of other sizes are not initialized.
+ */
+class TTFStrikeFontData : public FontData {
+    MappedFile file_{};
+    TTFStrike strike_{};
+
+public:
+    /// @brief Map the strike file at **path**.
+    explicit TTFStrikeFontData(const char *path);
+
+    /// @brief Use the strike at **data** in place, 4 bytes aligned, e.g. a font header array.
+    TTFStrikeFontData(const uint8_t *data, uint32_t size);
+
+    ~TTFStrikeFontData() override = default;
+
+    /// @brief True if the strike is valid for the display resolution in use.
+    [[nodiscard]] inline auto isLoaded() const -> bool { return strike_.isLoaded(); }
+
+    [[nodiscard]] auto getStrike() const -> const TTFStrike * override {
+        return strike_.isLoaded() ? &strike_ : nullptr;
+    }
+
+    auto ligKern(const GlyphCode /*glyphCode1*/, GlyphCode * /*glyphCode2*/, FIX16 *kern) const
+        -> bool override {
+        // The strike holds the ligatures and kerning of each size
+        *kern = 0;
+        return false;
+    }
+
+    [[nodiscard]] auto getData() const -> MemoryPtr override { return nullptr; }
+    [[nodiscard]] auto getDataSize() const -> int override { return 0; }
+
+    [[nodiscard]] auto getPrivateData() const -> MemoryPtr override { return nullptr; }
+    [[nodiscard]] auto getPrivateDataSize() const -> int override { return 0; }
+
+    /// @brief Hash of the font data the strike was built from: its glyphs are the same.
+    [[nodiscard]] auto getDataHash() const -> uint32_t override {
+        return strike_.getFontHash();
+    }
+};
+
+#endif
@@ -0,0 +1,58 @@
+#include "AllocationCounter.hpp"
+
+#include <cstdlib>
+#include <new>
+
+static thread_local uint32_t newCount = 0;
+
+auto getAllocationCount() -> uint32_t {
+#if CONFIG_TINYFONT_COUNT_ALLOCATIONS
+    return newCount + fontAllocationCount;
+#else
+    return newCount;
+#endif
+}
+
+static auto allocate(std::size_t size) noexcept -> void * {
+    newCount++;
+    return std::malloc((size == 0) ? 1 : size);
+}
+
+static auto allocate(std::size_t size, std::align_val_t alignment) noexcept -> void * {
+    newCount++;
+    auto align = static_cast<std::size_t>(alignment);
+    return std::aligned_alloc(align, ((size + align - 1) / align) * align);
+}
+
+static auto checked(void *block) -> void * {
+    if (block == nullptr) {
+        throw std::bad_alloc();
+    }
+    return block;
+}
+
+auto operator new(std::size_t size) -> void * { return checked(allocate(size)); }
+auto operator new[](std::size_t size) -> void * { return checked(allocate(size)); }
+auto operator new(std::size_t size, std::align_val_t alignment) -> void * {
+    return checked(allocate(size, alignment));
+}
+auto operator new[](std::size_t size, std::align_val_t alignment) -> void * {
+    return checked(allocate(size, alignment));
+}
+auto operator new(std::size_t size, const std::nothrow_t &) noexcept -> void * {
+    return allocate(size);
+}
+auto operator new[](std::size_t size, const std::nothrow_t &) noexcept -> void * {
+    return allocate(size);
+}
+
+void operator delete(void *block) noexcept { std::free(block); }
+void operator delete[](void *block) noexcept { std::free(block); }
+void operator delete(void *block, std::size_t) noexcept { std::free(block); }
+void operator delete[](void *block, std::size_t) noexcept { std::free(block); }
+void operator delete(void *block, std::align_val_t) noexcept { std::free(block); }
+void operator delete[](void *block, std::align_val_t) noexcept { std::free(block); }
+void operator delete(void *block, std::size_t, std::align_val_t) noexcept { std::free(block); }
+void operator delete[](void *block, std::size_t, std::align_val_t) noexcept { std::free(block); }
+void operator delete(void *block, const std::nothrow_t &) noexcept { std::free(block); }
+void operator delete[](void *block, const std::nothrow_t &) noexcept { std::free(block); }
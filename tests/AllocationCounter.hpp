@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstdint>
+
+#include "Misc/SpiramAllocator.hpp"
+
+// Heap allocations made by the calling thread: the operator new calls, replaced in
+// AllocationCounter.cpp, and with CONFIG_TINYFONT_COUNT_ALLOCATIONS the blocks of the font
+// caches (fontMalloc() and FontSpiramAllocator).
+
+auto getAllocationCount() -> uint32_t;
+
+/// Number of heap allocations made by **call**.
+template <typename Call> auto countAllocations(Call &&call) -> uint32_t {
+    uint32_t before = getAllocationCount();
+    call();
+    return getAllocationCount() - before;
+}
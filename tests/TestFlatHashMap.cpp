@@ -0,0 +1,58 @@
+#define CATCH_CONFIG_MAIN
+#include <Misc/FlatHashMap.hpp>
+#include <random>
+#include <unordered_map>
+
+#include "Catch2/catch_amalgamated.hpp"
+
+TEST_CASE("FlatHashMap finds what was inserted", "[flatmap]") {
+    FlatHashMap<uint32_t> map;
+
+    CHECK(map.find(12) == nullptr);
+    CHECK(map.insert(12, 120));
+    CHECK(map.insert(13, 130));
+    REQUIRE(map.find(12) != nullptr);
+    CHECK(*map.find(12) == 120);
+    CHECK(*map.find(13) == 130);
+    CHECK(map.size() == 2);
+
+    CHECK(map.insert(12, 121));
+    CHECK(*map.find(12) == 121);
+    CHECK(map.size() == 2);
+
+    CHECK(map.erase(12));
+    CHECK_FALSE(map.erase(12));
+    CHECK(map.find(12) == nullptr);
+    CHECK(*map.find(13) == 130);
+}
+
+TEST_CASE("FlatHashMap matches std::unordered_map under random operations", "[flatmap]") {
+    FlatHashMap<uint32_t> map;
+    std::unordered_map<uint32_t, uint32_t> reference;
+    std::mt19937 rng(1234);
+
+    for (int i = 0; i < 20000; i++) {
+        // Glyph cache like keys: a few sizes and a small set of glyph codes.
+        uint32_t key = ((rng() % 4) << 16) | (rng() % 600);
+        if ((rng() % 3) == 0) {
+            CHECK(map.erase(key) == (reference.erase(key) == 1));
+        } else {
+            CHECK(map.insert(key, i));
+            reference[key] = i;
+        }
+    }
+
+    CHECK(map.size() == reference.size());
+    for (const auto &entry : reference) {
+        REQUIRE(map.find(entry.first) != nullptr);
+        CHECK(*map.find(entry.first) == entry.second);
+    }
+
+    uint32_t count = 0;
+    map.forEach([&count](uint32_t, uint32_t) { count++; });
+    CHECK(count == reference.size());
+
+    map.clear();
+    CHECK(map.size() == 0);
+    CHECK(map.find(reference.begin()->first) == nullptr);
+}
@@ -1,10 +1,13 @@
 #define CATCH_CONFIG_MAIN
+#include <algorithm>
 #include <cstdio>
 #include <string>
 #include <vector>
 
+#include "AllocationCounter.hpp"
 #include "Catch2/catch_amalgamated.hpp"
 #include "Font.hpp"
+#include "IBMFDriver/IBMFFileFontData.hpp"
 #include "IBMFDriver/IBMFFontData.hpp"
 #include "IBMFFonts/SolSans_75.h"
 #include "ImageIO.hpp"
@@ -13,9 +16,8 @@
 using namespace ibmf_defs;
 using namespace font_defs;
 
-static auto renderTextIBMF(const std::string &text, int faceIndex, int &outW, int &outH)
-    -> std::vector<uint8_t> {
-    FontData fontData(SOLSANS_75_IBMF, SOLSANS_75_IBMF_LEN);
+static auto renderTextIBMF(FontData &fontData, const std::string &text, int faceIndex, int &outW,
+                           int &outH) -> std::vector<uint8_t> {
     Font font(fontData, faceIndex);
 
     const int inset = 10;
@@ -49,6 +51,12 @@ static auto renderTextIBMF(const std::string &text, int faceIndex, int &outW, in
     return out;
 }
 
+static auto renderTextIBMF(const std::string &text, int faceIndex, int &outW, int &outH)
+    -> std::vector<uint8_t> {
+    FontData fontData(SOLSANS_75_IBMF, SOLSANS_75_IBMF_LEN);
+    return renderTextIBMF(fontData, text, faceIndex, outW, outH);
+}
+
 TEST_CASE("IBMF renders Tiny Font line for all faces matches golden", "[ibmf]") {
     const std::string line = "Tiny Font: A Minimal Font Library";
     for (int face = 0; face < 3; ++face) {
@@ -241,3 +249,137 @@ TEST_CASE("IBMF glyph grids for multiple blocks", "[ibmf][glyphs]") {
         }
     }
 }
+
+TEST_CASE("IBMF prefetch keeps the optical kerning of glyph pairs", "[ibmf][prefetch]") {
+    FontData fontData(SOLSANS_75_IBMF, SOLSANS_75_IBMF_LEN);
+    Font font(fontData, 0);
+
+    const std::string text = "Tiny Font: A Minimal Font Library";
+    CHECK(font.prefetch(text) > 0);
+    CHECK(font.prefetch(text) == 0);
+
+    // The kept values must give the same rendering as freshly computed ones.
+    int W = 0, H = 0;
+    auto fresh = renderTextIBMF(text, 0, W, H);
+
+    const int inset = 10;
+    Bitmap canvas;
+    canvas.dim = Dim(W, H);
+    canvas.pitch = (W + 7) >> 3;
+    std::vector<uint8_t> pixels(static_cast<size_t>(canvas.pitch) * H, 0xFF);
+    canvas.pixels = pixels.data();
+    font.drawSingleLineOfText(canvas, Pos(inset, inset), text, false);
+
+    std::vector<uint8_t> out(static_cast<size_t>(W * H), 255);
+    for (int y = 0; y < H; ++y) {
+        for (int x = 0; x < W; ++x) {
+            uint8_t byte = pixels[static_cast<size_t>(y * canvas.pitch + (x >> 3))];
+            bool on = (byte >> (7 - (x & 7))) & 1;
+            out[static_cast<size_t>(y * W + x)] = on ? 0 : 255;
+        }
+    }
+    CHECK(out == fresh);
+}
+
+TEST_CASE("IBMF optical kerning cache stays within its budget", "[ibmf][kerning]") {
+    FontData fontData(SOLSANS_75_IBMF, SOLSANS_75_IBMF_LEN);
+    IBMFFace *face = fontData.getFace(0);
+    REQUIRE(face != nullptr);
+
+    // Twice as many glyph pairs as the budget, each one computed once.
+    const int glyphs = 32;
+    static_assert(glyphs * glyphs > 2 * CONFIG_TINYFONT_IBMF_OPTICAL_KERN_COUNT);
+    uint32_t maxCount = 0;
+    for (GlyphCode g1 = 0; g1 < glyphs; ++g1) {
+        for (GlyphCode g2 = 0; g2 < glyphs; ++g2) {
+            GlyphCode next = g2;
+            FIX16 kern = 0;
+            face->ligKern(g1, &next, &kern);
+            maxCount = std::max(maxCount, face->getOpticalKernCount());
+        }
+    }
+    CHECK(maxCount == CONFIG_TINYFONT_IBMF_OPTICAL_KERN_COUNT);
+    CHECK(face->getOpticalKernCount() <= CONFIG_TINYFONT_IBMF_OPTICAL_KERN_COUNT);
+
+    face->clearOpticalKerns();
+    CHECK(face->getOpticalKernCount() == 0);
+}
+
+TEST_CASE("IBMF hot path statistics count the rendering steps", "[ibmf][stats]") {
+    FontData fontData(SOLSANS_75_IBMF, SOLSANS_75_IBMF_LEN);
+    Font font(fontData, 0);
+
+    const std::string text = "Tiny Font: A Minimal Font Library";
+    font_stats::resetStats();
+
+    Bitmap canvas;
+    canvas.dim = Dim(font.getTextWidth(text) + 20, font.lineHeight() + 20);
+    canvas.pitch = (canvas.dim.width + 7) >> 3;
+    std::vector<uint8_t> pixels(static_cast<size_t>(canvas.pitch) * canvas.dim.height, 0xFF);
+    canvas.pixels = pixels.data();
+    font.drawSingleLineOfText(canvas, Pos(10, 10), text, false);
+    FontStats first = font_stats::getStats();
+    font.drawSingleLineOfText(canvas, Pos(10, 10), text, false);
+    FontStats second = font_stats::getStats();
+
+#if CONFIG_TINYFONT_STATS
+    CHECK(first[StatId::TRANSLATE].count >= text.size());
+    CHECK(first[StatId::LIG_KERN].count > 0);
+    CHECK(first[StatId::RLE_DECODE].count > 0);
+    CHECK(first[StatId::RLE_DECODE].ticks > 0);
+    CHECK(first[StatId::OPTICAL_KERN].count > 0);
+
+    // The optical kerning of the pairs is only computed once
+    CHECK(second[StatId::OPTICAL_KERN].count == first[StatId::OPTICAL_KERN].count);
+    CHECK(second[StatId::TRANSLATE].count > first[StatId::TRANSLATE].count);
+#else
+    for (const FontStats &stats : {first, second}) {
+        for (const FontStats::Entry &entry : stats.entries) {
+            CHECK(entry.count == 0);
+            CHECK(entry.ticks == 0);
+        }
+    }
+#endif
+}
+
+TEST_CASE("IBMF warm text drawing and measuring do not allocate", "[ibmf][alloc]") {
+    FontData fontData(SOLSANS_75_IBMF, SOLSANS_75_IBMF_LEN);
+    Font font(fontData, 0);
+
+    const std::string text = "Office affine: AVATAR Wave, d\u00E9j\u00E0 vu";
+    Bitmap canvas;
+    canvas.dim = Dim(font.getTextWidth(text) + 20, font.lineHeight() + 20);
+    canvas.pitch = (canvas.dim.width + 7) >> 3;
+    std::vector<uint8_t> pixels(static_cast<size_t>(canvas.pitch) * canvas.dim.height, 0xFF);
+    canvas.pixels = pixels.data();
+
+    CHECK(countAllocations([] { std::vector<uint8_t> block(100); }) == 1);
+
+    // Warm: the optical kerning of the pairs is computed
+    font.drawSingleLineOfText(canvas, Pos(10, 10), text, false);
+
+    CHECK(countAllocations(
+              [&] { font.drawSingleLineOfText(canvas, Pos(10, 10), text, false); }) == 0);
+    CHECK(countAllocations([&] { (void)font.getTextWidth(text); }) == 0);
+    CHECK(countAllocations([&] { (void)font.getTextSize(text); }) == 0);
+}
+
+TEST_CASE("IBMF font file renders as the embedded font", "[ibmf][file]") {
+    IBMFFileFontData fileData(FONTS_DIR "/IBMFFonts/SolSans_75.ibmf");
+    REQUIRE(fileData.isInitialized());
+    CHECK(fileData.getFaceCount() == FontData(SOLSANS_75_IBMF, SOLSANS_75_IBMF_LEN).getFaceCount());
+
+    const std::string text = "Tiny Font: A Minimal Font Library";
+    for (int face = 0; face < fileData.getFaceCount(); ++face) {
+        INFO("IBMF face index " << face);
+        int W = 0, H = 0, fileW = 0, fileH = 0;
+        auto embedded = renderTextIBMF(text, face, W, H);
+        auto fromFile = renderTextIBMF(fileData, text, face, fileW, fileH);
+        REQUIRE(fileW == W);
+        REQUIRE(fileH == H);
+        CHECK(fromFile == embedded);
+    }
+
+    IBMFFileFontData missing(FONTS_DIR "/IBMFFonts/Missing.ibmf");
+    CHECK_FALSE(missing.isInitialized());
+}
@@ -1,11 +1,24 @@
 #define CATCH_CONFIG_MAIN
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
 #include <string>
 #include <vector>
 
+#include "AllocationCounter.hpp"
 #include "Catch2/catch_amalgamated.hpp"
 #include "Font.hpp"
 #include "ImageIO.hpp"
+#include "Misc/FNVHash.hpp"
+#include "Misc/FontLog.hpp"
+#include "Misc/FontTrace.hpp"
+#include "TTFDriver/TTFFileFontData.hpp"
 #include "TTFDriver/TTFNotoSansLight.hpp"
+#include "TTFDriver/TTFStreamFontData.hpp"
+#include "TTFDriver/TTFStrikeFontData.hpp"
+#include "TTFStrikeWriter.hpp"
 #include "TestHelpers.hpp"
 
 using namespace ttf_defs;
@@ -128,6 +141,29 @@ static auto renderGlyphGridTTF(const std::vector<std::string> &glyphs, int gridW
     return out;
 }
 
+// Draw **line** at **pos** in a white canvas of **width** by **height** pixels, at the display
+// pixel resolution of **font**, returning the canvas pixels. A **height** of 0 is the line height
+// of **font** plus 20 rows. **endX**, if given, receives the x position at the end of the line.
+static auto renderLine(Font &font, const std::string &line, int width, int height = 0,
+                       Pos pos = Pos(10, 10), int *endX = nullptr) -> std::vector<uint8_t> {
+    PixelResolution resolution = font.getDisplayPixelResolution();
+    if (height == 0) {
+        height = font.lineHeight() + 20;
+    }
+    // The pitch of the 16 and 24 bits canvas is in pixels
+    size_t bytes = static_cast<size_t>(canvasPitch(width, resolution)) * height *
+                   std::max(bitsPerPixel(resolution) / 8, 1);
+    std::vector<uint8_t> out(bytes, 255);
+    Bitmap canvas;
+    canvas.dim = Dim(width, height);
+    canvas.pixels = out.data();
+    int end = font.drawSingleLineOfText(canvas, pos, line, false);
+    if (endX != nullptr) {
+        *endX = end;
+    }
+    return out;
+}
+
 TEST_CASE("TTF glyph grids for blocks and sizes", "[ttf][glyphs]") {
     const int sizes[] = {16, 20, 22, 24};
 
@@ -181,3 +217,990 @@ TEST_CASE("TTF glyph grids for blocks and sizes", "[ttf][glyphs]") {
         }
     }
 }
+
+// ---- Glyph cache storage ----
+
+static auto renderWithCacheBudget(const std::string &text, int ptSize, uint32_t budget)
+    -> std::vector<uint8_t> {
+    TTFNotoSansLight fontData;
+    fontData.cache.setBudget(budget);
+    Font font(fontData, ptSize);
+
+    std::vector<uint8_t> out = renderLine(font, text, 900);
+
+    CHECK(fontData.cache.getAllocatedBytes() <= budget);
+    return out;
+}
+
+TEST_CASE("TTF cache evicts and compacts glyphs under a small budget", "[ttf][cache]") {
+    const std::string line = "The quick brown fox jumps over the lazy dog 0123456789 ÀÉÎÕÜ";
+    auto reference = renderWithCacheBudget(line, 28, 1024 * 1024);
+    auto constrained = renderWithCacheBudget(line, 28, 20 * 1024);
+    REQUIRE(reference.size() == constrained.size());
+    CHECK(reference == constrained);
+}
+
+TEST_CASE("TTF cache makes room for a large glyph once its budget is full", "[ttf][cache]") {
+    const uint32_t budget = 64 * 1024;
+    TTFNotoSansLight fontData;
+    fontData.cache.setBudget(budget);
+
+    // Body text glyphs of both pixel resolutions fill the budget
+    std::string text;
+    for (int code = 0x21; code <= 0x17F; code++) {
+        if ((code < 0x7F) || (code > 0xA0)) {
+            text += codePointToUtf8(code);
+        }
+    }
+    Font body(fontData, 14);
+    for (PixelResolution resolution : {PixelResolution::EIGHT_BITS, PixelResolution::ONE_BIT}) {
+        body.setFontPixelResolution(resolution);
+        renderLine(body, text, 4000);
+    }
+    CHECK(fontData.cache.getEvictCount() > 0);
+
+    // Glyphs too wide or too tall for a regular atlas page, cached after evictions
+    Font large(fontData, 100);
+    large.setDirectRenderSize(0);
+    for (const std::string glyph : {"W", "["}) {
+        std::vector<uint8_t> first = renderLine(large, glyph, 400);
+        uint32_t misses = fontData.cache.getMissCount();
+        CHECK(std::count_if(first.begin(), first.end(), [](uint8_t pixel) {
+                  return pixel < 128;
+              }) > 0);
+        CHECK(renderLine(large, glyph, 400) == first);
+        CHECK(fontData.cache.getMissCount() == misses);
+        CHECK(fontData.cache.getAllocatedBytes() <= budget);
+    }
+}
+
+TEST_CASE("TTF cache keeps glyphs of both pixel resolutions", "[ttf][cache]") {
+    TTFNotoSansLight fontData;
+    Font font(fontData, 16);
+
+    const std::string line = "Mono chrome and anti-aliased body text";
+    auto render = [&]() { return renderLine(font, line, 600); };
+
+    auto antialiased = render();
+    font.setFontPixelResolution(PixelResolution::ONE_BIT);
+    auto mono = render();
+    CHECK(antialiased != mono);
+
+    // Switching back and forth must not reload any glyph.
+    uint32_t misses = fontData.cache.getMissCount();
+    font.setFontPixelResolution(PixelResolution::EIGHT_BITS);
+    CHECK(render() == antialiased);
+    font.setFontPixelResolution(PixelResolution::ONE_BIT);
+    CHECK(render() == mono);
+    CHECK(fontData.cache.getMissCount() == misses);
+}
+
+TEST_CASE("TTF 2 and 4 bits glyphs are packed in the cache and the canvas", "[ttf][packed]") {
+    const std::string line = "Packed e-ink: AVATAR 0123";
+    const int width = 501; // Rows ending in the middle of a byte
+
+    TTFNotoSansLight fontData;
+    Font font(fontData, 18);
+    const int height = font.lineHeight() + 20;
+    REQUIRE(font.getTextWidth(line) + 20 < width);
+
+    auto render = [&](Pos pos) { return renderLine(font, line, width, 0, pos); };
+
+    auto level = [&](const std::vector<uint8_t> &canvas, int bits, int x, int y) {
+        int bit = x * bits;
+        int pitch = canvasPitch(width, font.getDisplayPixelResolution());
+        return (canvas[y * pitch + (bit >> 3)] >> (8 - bits - (bit & 7))) & ((1 << bits) - 1);
+    };
+
+    for (auto resolution : {PixelResolution::TWO_BITS, PixelResolution::FOUR_BITS}) {
+        const int bits = bitsPerPixel(resolution);
+        INFO("Resolution " << bits << " bits");
+
+        font.setFontPixelResolution(PixelResolution::EIGHT_BITS);
+        REQUIRE(font.setDisplayPixelResolution(resolution));
+
+        // Packed glyphs, copied a byte at a time, draw as the 8 bits ones requantized a pixel
+        // at a time, at every position in a canvas byte.
+        for (int16_t x = 10; x < 10 + 8 / bits; x++) {
+            font.setFontPixelResolution(PixelResolution::EIGHT_BITS);
+            auto requantized = render(Pos(x, 10));
+            font.setFontPixelResolution(resolution);
+            REQUIRE(font.getFontPixelResolution() == resolution);
+            auto packed = render(Pos(x, 10));
+            CHECK(std::count(packed.begin(), packed.end(), 0xFF) <
+                  static_cast<std::ptrdiff_t>(packed.size()));
+            CHECK((packed == requantized));
+        }
+
+        // Atlas pages have their own pitch
+        auto glyph = font.getCachedGlyph(font.translate('W'));
+        REQUIRE(glyph.has_value());
+        if (!CONFIG_TINYFONT_TTF_CACHE_ATLAS) {
+            CHECK(glyph.value()->bitmap.pitch ==
+                  glyphRowBytes(glyph.value()->bitmap.dim.width, resolution));
+        }
+
+        // 1 bit glyphs are black on the packed display
+        font.setFontPixelResolution(PixelResolution::ONE_BIT);
+        auto mono = render(Pos(11, 10));
+        REQUIRE(font.setDisplayPixelResolution(PixelResolution::ONE_BIT));
+        auto reference = render(Pos(11, 10));
+        int pitch = canvasPitch(width, PixelResolution::ONE_BIT);
+        REQUIRE(font.setDisplayPixelResolution(resolution));
+        int mismatches = 0;
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                bool ink = (reference[y * pitch + (x >> 3)] & (0x80 >> (x & 7))) == 0;
+                int expected = ink ? 0 : (1 << bits) - 1;
+                mismatches += (level(mono, bits, x, y) != expected) ? 1 : 0;
+            }
+        }
+        CHECK(mismatches == 0);
+    }
+
+    // Expanded to 8 bits, the 4 bits glyphs are within a level of the 8 bits ones
+    REQUIRE(font.setDisplayPixelResolution(PixelResolution::EIGHT_BITS));
+    font.setFontPixelResolution(PixelResolution::EIGHT_BITS);
+    auto gray = render(Pos(10, 10));
+    font.setFontPixelResolution(PixelResolution::FOUR_BITS);
+    auto expanded = render(Pos(10, 10));
+    int worst = 0;
+    for (size_t i = 0; i < gray.size(); i++) {
+        worst = std::max(worst, std::abs(gray[i] - expanded[i]));
+    }
+    CHECK(worst <= 17);
+}
+
+TEST_CASE("TTF 1 bit glyphs derived from the 8 bits ones", "[ttf][mono]") {
+    const std::string line = "Dithered mono: AVATAR 0123";
+    const int width = 563; // Rows ending in the middle of a byte
+
+    TTFNotoSansLight fontData;
+    Font font(fontData, 18);
+    const int height = font.lineHeight() + 20;
+    REQUIRE(font.getTextWidth(line) + 30 < width);
+
+    auto render = [&](Pos pos) { return renderLine(font, line, width, 0, pos); };
+
+    auto ink = [&](const std::vector<uint8_t> &canvas, int x, int y) {
+        int pitch = canvasPitch(width, PixelResolution::ONE_BIT);
+        return (canvas[y * pitch + (x >> 3)] & (0x80 >> (x & 7))) == 0;
+    };
+
+    const uint8_t bayer[8][8] = {{0, 32, 8, 40, 2, 34, 10, 42},  {48, 16, 56, 24, 50, 18, 58, 26},
+                                 {12, 44, 4, 36, 14, 46, 6, 38}, {60, 28, 52, 20, 62, 30, 54, 22},
+                                 {3, 35, 11, 43, 1, 33, 9, 41},  {51, 19, 59, 27, 49, 17, 57, 25},
+                                 {15, 47, 7, 39, 13, 45, 5, 37}, {63, 31, 55, 23, 61, 29, 53, 21}};
+
+    REQUIRE(font.setDisplayPixelResolution(PixelResolution::EIGHT_BITS));
+    font.setFontPixelResolution(PixelResolution::EIGHT_BITS);
+
+    for (int16_t x = 10; x < 18; x++) {
+        INFO("At x = " << x);
+        REQUIRE(font.setDisplayPixelResolution(PixelResolution::EIGHT_BITS));
+        font.setFontPixelResolution(PixelResolution::EIGHT_BITS);
+        auto gray = render(Pos(x, 10));
+
+        // The 1 bit glyphs come from the cached 8 bits ones
+        uint32_t misses = fontData.cache.getMissCount();
+        REQUIRE(font.setDisplayPixelResolution(PixelResolution::ONE_BIT));
+        REQUIRE(font.getFontPixelResolution() == PixelResolution::ONE_BIT);
+
+        font.setMonoRendering(MonoRendering::THRESHOLD);
+        auto thresholded = render(Pos(x, 10));
+        font.setMonoRendering(MonoRendering::ORDERED_DITHER);
+        auto dithered = render(Pos(x, 10));
+        CHECK(fontData.cache.getMissCount() == misses);
+
+        int thresholdMismatches = 0;
+        int ditherMismatches = 0;
+        int inkCount = 0;
+        for (int y = 0; y < height; y++) {
+            for (int i = 0; i < width; i++) {
+                int coverage = 255 - gray[y * width + i];
+                thresholdMismatches += (ink(thresholded, i, y) != (coverage >= 128)) ? 1 : 0;
+                bool dither = coverage >= 4 * bayer[y & 7][i & 7] + 2;
+                ditherMismatches += (ink(dithered, i, y) != dither) ? 1 : 0;
+                inkCount += dither ? 1 : 0;
+            }
+        }
+        CHECK(inkCount > 0);
+        CHECK(thresholdMismatches == 0);
+        CHECK(ditherMismatches == 0);
+
+        // Hinted glyphs are rendered again, apart from the 8 bits ones
+        font.setMonoRendering(MonoRendering::HINTED);
+        CHECK(render(Pos(x, 10)) != thresholded);
+        font.setMonoRendering(MonoRendering::THRESHOLD);
+    }
+
+    // The 8 bits displays receive the same 1 bit glyphs
+    REQUIRE(font.setDisplayPixelResolution(PixelResolution::ONE_BIT));
+    font.setMonoRendering(MonoRendering::ORDERED_DITHER);
+    auto reference = render(Pos(11, 10));
+    REQUIRE(font.setDisplayPixelResolution(PixelResolution::EIGHT_BITS));
+    REQUIRE(font.getFontPixelResolution() == PixelResolution::ONE_BIT);
+    auto gray = render(Pos(11, 10));
+    int mismatches = 0;
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            mismatches += (gray[y * width + x] != (ink(reference, x, y) ? 0 : 255)) ? 1 : 0;
+        }
+    }
+    CHECK(mismatches == 0);
+}
+
+TEST_CASE("TTF prefetch loads the glyphs ahead of rendering", "[ttf][cache]") {
+    TTFNotoSansLight fontData;
+    Font font(fontData, 20);
+
+    const std::string line = "Prefetched glyphs: ÀÉÎÕÜ 0123456789";
+    CHECK(fontData.cache.prefetch(font, line) > 0);
+    CHECK(font.prefetch(line) == 0);
+    CHECK(fontData.cache.prefetch(font, U'A', U'Z') > 0);
+
+    uint32_t misses = fontData.cache.getMissCount();
+    renderLine(font, line + " ABCXYZ", 700);
+    CHECK(fontData.cache.getMissCount() == misses);
+
+#if CONFIG_TINYFONT_TTF_ASYNC_PREFETCH
+    Font bigFont(fontData, 30);
+    uint32_t loaded = 0;
+    fontData.cache.prefetchAsync(bigFont, line, [&loaded](uint32_t count) { loaded = count; });
+    fontData.cache.waitPrefetch();
+    CHECK(loaded > 0);
+    CHECK(bigFont.prefetch(line) == 0);
+#endif
+}
+
+TEST_CASE("TTF cache snapshot restores the glyphs without FreeType", "[ttf][cache][snapshot]") {
+    const std::string line = "Warm boot from a snapshot: ÀÉÎÕÜ 0123456789";
+    const std::string path =
+        (std::filesystem::temp_directory_path() /
+         ("tinyfont_snapshot_" + std::to_string(CONFIG_TINYFONT_TTF_CACHE_ATLAS) + ".bin"))
+            .string();
+
+    auto render = [&line](Font &font) { return renderLine(font, line, 800); };
+
+    std::vector<uint8_t> reference;
+    {
+        TTFNotoSansLight fontData;
+        Font font(fontData, 18);
+        reference = render(font);
+        font.setFontPixelResolution(PixelResolution::ONE_BIT);
+        render(font);
+        REQUIRE(fontData.saveCacheSnapshot(path.c_str()));
+    }
+
+    {
+        TTFNotoSansLight fontData;
+        REQUIRE(fontData.loadCacheSnapshot(path.c_str()));
+        Font font(fontData, 18);
+        CHECK(render(font) == reference);
+        font.setFontPixelResolution(PixelResolution::ONE_BIT);
+        render(font);
+        CHECK(fontData.cache.getMissCount() == 0);
+    }
+
+    {
+        // Another font hash
+        TTFNotoSansLight fontData;
+        CHECK_FALSE(fontData.cache.loadSnapshot(path.c_str(), fontData.getDataHash() + 1,
+                                                fontData.outlines.isEnabled()));
+    }
+
+    {
+        // Glyphs rendered from the outlines' cache are not hinted: the hinted ones of the
+        // snapshot are not for them.
+        TTFNotoSansLight fontData;
+        fontData.outlines.setBudget(64 * 1024);
+        CHECK_FALSE(fontData.loadCacheSnapshot(path.c_str()));
+        CHECK(fontData.cache.getAllocatedBytes() == 0);
+    }
+
+    {
+        // A corrupted snapshot is ignored
+        FILE *file = fopen(path.c_str(), "r+b");
+        REQUIRE(file != nullptr);
+        fseek(file, -1, SEEK_END);
+        int byte = fgetc(file);
+        fseek(file, -1, SEEK_END);
+        fputc(byte ^ 0xFF, file);
+        fclose(file);
+
+        TTFNotoSansLight fontData;
+        CHECK_FALSE(fontData.loadCacheSnapshot(path.c_str()));
+        CHECK(fontData.cache.getAllocatedBytes() == 0);
+    }
+
+    {
+        // Entries with a valid checksum but a width larger than their rows, or an unknown pixel
+        // resolution, are rejected. The first entry follows the 28 bytes header, the low byte
+        // of its width at offset 14 and its resolution in the high nibble of its key.
+        std::vector<uint8_t> snapshot;
+        {
+            TTFNotoSansLight fontData;
+            Font font(fontData, 18);
+            render(font);
+            REQUIRE(fontData.saveCacheSnapshot(path.c_str()));
+            std::ifstream in(path, std::ios::binary);
+            snapshot.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        }
+        auto loadPatched = [&](size_t offset, uint8_t value) {
+            std::vector<uint8_t> patched = snapshot;
+            patched[offset] = value;
+            uint32_t checksum = fnv1a(patched.data() + 28, patched.size() - 28);
+            memcpy(patched.data() + 20, &checksum, sizeof(checksum));
+            std::ofstream(path, std::ios::binary)
+                .write(reinterpret_cast<const char *>(patched.data()),
+                       static_cast<std::streamsize>(patched.size()));
+
+            TTFNotoSansLight fontData;
+            return fontData.loadCacheSnapshot(path.c_str());
+        };
+        REQUIRE(loadPatched(28 + 14, snapshot[28 + 14]));
+        CHECK_FALSE(loadPatched(28 + 14, 0xFF));
+        CHECK_FALSE(loadPatched(28 + 3, 0x70));
+    }
+
+    remove(path.c_str());
+}
+
+TEST_CASE("TTF metrics-only path matches the rendered glyphs", "[ttf][cache][metrics]") {
+    TTFNotoSansLight fontData;
+
+    for (auto resolution :
+         {PixelResolution::EIGHT_BITS, PixelResolution::ONE_BIT, PixelResolution::FOUR_BITS}) {
+        for (int ptSize : {8, 12, 17, 28}) {
+            Font font(fontData, ptSize);
+            font.setFontPixelResolution(resolution);
+            for (GlyphCode glyphCode = 0; glyphCode < 700; glyphCode++) {
+                INFO("Resolution " << static_cast<int>(resolution) << ", size " << ptSize
+                                   << ", glyph " << glyphCode);
+                TTFCache::Measure measure;
+                Glyph glyph;
+                REQUIRE(font.getMeasureForCache(glyphCode, measure));
+                REQUIRE(font.getGlyphForCache(glyphCode, glyph));
+                CHECK(measure.width == glyph.bitmap.dim.width);
+                CHECK(measure.metrics.xoff == glyph.metrics.xoff);
+                CHECK(measure.metrics.yoff == glyph.metrics.yoff);
+                CHECK(measure.metrics.descent == glyph.metrics.descent);
+                CHECK(measure.metrics.advance == glyph.metrics.advance);
+                CHECK(measure.metrics.lineHeight == glyph.metrics.lineHeight);
+            }
+        }
+    }
+}
+
+TEST_CASE("TTF text measurement does not render glyphs", "[ttf][cache][metrics]") {
+    TTFNotoSansLight fontData;
+    Font font(fontData, 14);
+
+    const std::string text = "Measured but never drawn: ÀÉÎÕÜ 0123456789";
+    uint32_t misses = fontData.cache.getMissCount(); // The space glyph, loaded by the Font
+    Dim dim = font.getTextSize(text);
+    int width = font.getTextWidth(text);
+    int16_t quickWidth = font.getTextWidthQuick(text.c_str());
+    CHECK(fontData.cache.getMissCount() == misses);
+    CHECK(fontData.cache.getMeasureMissCount() > 0);
+
+    // Same measures once the glyphs are rendered in the cache.
+    CHECK(font.prefetch(text) > 0);
+    CHECK(font.getTextSize(text).width == dim.width);
+    CHECK(font.getTextSize(text).height == dim.height);
+    CHECK(font.getTextWidth(text) == width);
+    CHECK(font.getTextWidthQuick(text.c_str()) == quickWidth);
+}
+
+TEST_CASE("TTF hot path statistics count the rendering steps", "[ttf][stats]") {
+    TTFNotoSansLight fontData;
+    Font font(fontData, 14);
+
+    const std::string text = "Statistics of the hot paths";
+    Bitmap canvas;
+    canvas.dim = Dim(font.getTextWidth(text) + 20, font.lineHeight() + 20);
+    canvas.pitch = canvas.dim.width;
+    std::vector<uint8_t> pixels(static_cast<size_t>(canvas.pitch) * canvas.dim.height, 0xFF);
+    canvas.pixels = pixels.data();
+
+    font_stats::resetStats();
+    font.drawSingleLineOfText(canvas, Pos(10, 10), text, false);
+    FontStats first = font_stats::getStats();
+    font.drawSingleLineOfText(canvas, Pos(10, 10), text, false);
+    FontStats second = font_stats::getStats();
+
+#if CONFIG_TINYFONT_STATS
+    CHECK(first[StatId::TRANSLATE].count >= text.size());
+    CHECK(first[StatId::LIG_KERN].count > 0);
+    CHECK(first[StatId::CACHE_MISS].count > 0);
+    CHECK(first[StatId::GLYPH_LOAD].count > 0);
+    CHECK(first[StatId::GLYPH_RENDER].count == first[StatId::CACHE_MISS].count);
+    CHECK(first[StatId::GLYPH_RENDER].ticks > 0);
+    CHECK(first[StatId::BLIT].count > 0);
+
+    // Drawn again from the cache
+    CHECK(second[StatId::CACHE_MISS].count == first[StatId::CACHE_MISS].count);
+    CHECK(second[StatId::GLYPH_RENDER].count == first[StatId::GLYPH_RENDER].count);
+    CHECK(second[StatId::CACHE_HIT].count - first[StatId::CACHE_HIT].count ==
+          first[StatId::BLIT].count);
+    CHECK(second[StatId::BLIT].count == 2 * first[StatId::BLIT].count);
+#else
+    for (const FontStats &stats : {first, second}) {
+        for (const FontStats::Entry &entry : stats.entries) {
+            CHECK(entry.count == 0);
+            CHECK(entry.ticks == 0);
+        }
+    }
+#endif
+}
+
+TEST_CASE("TTF warm text drawing and measuring do not allocate", "[ttf][alloc]") {
+    TTFNotoSansLight fontData;
+    Font font(fontData, 14);
+
+    const std::string text = "Office affine: AVATAR Wave, d\u00E9j\u00E0 vu";
+    Bitmap canvas;
+    canvas.dim = Dim(font.getTextWidth(text) + 20, font.lineHeight() + 20);
+    canvas.pitch = canvas.dim.width;
+    std::vector<uint8_t> pixels(static_cast<size_t>(canvas.pitch) * canvas.dim.height, 0xFF);
+    canvas.pixels = pixels.data();
+
+    // Warm: the glyphs and their metrics are in the cache
+    font.drawSingleLineOfText(canvas, Pos(10, 10), text, false);
+
+    CHECK(countAllocations(
+              [&] { font.drawSingleLineOfText(canvas, Pos(10, 10), text, false); }) == 0);
+    CHECK(countAllocations([&] { (void)font.getTextWidth(text); }) == 0);
+    CHECK(countAllocations([&] { (void)font.getTextSize(text); }) == 0);
+}
+
+#if CONFIG_TINYFONT_TRACE
+TEST_CASE("TTF tracer writes the draw calls as Chrome trace events", "[ttf][trace]") {
+    TTFNotoSansLight fontData;
+    Font font(fontData, 14);
+
+    const std::string text = "Traced \"line\" ÀÉ";
+    Bitmap canvas;
+    canvas.dim = Dim(font.getTextWidth(text) + 20, font.lineHeight() + 20);
+    canvas.pitch = canvas.dim.width;
+    std::vector<uint8_t> pixels(static_cast<size_t>(canvas.pitch) * canvas.dim.height, 0xFF);
+    canvas.pixels = pixels.data();
+
+    const std::string path =
+        (std::filesystem::temp_directory_path() / "tinyfont_trace.json").string();
+    font_trace::start();
+    font.drawSingleLineOfText(canvas, Pos(10, 10), text, false);
+    CHECK(font_trace::isRecording());
+    size_t eventCount = font_trace::getEventCount();
+    REQUIRE(font_trace::stop(path.c_str()));
+    CHECK(!font_trace::isRecording());
+
+    std::ifstream file(path);
+    std::string json((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    std::filesystem::remove(path);
+
+    auto occurrences = [&json](const std::string &pattern) {
+        size_t count = 0;
+        for (size_t pos = json.find(pattern); pos != std::string::npos;
+             pos = json.find(pattern, pos + 1)) {
+            count++;
+        }
+        return count;
+    };
+
+    CHECK(json.rfind("{\"displayTimeUnit\": \"ns\", \"traceEvents\": [", 0) == 0);
+    CHECK(occurrences("\"ph\": \"B\"") == eventCount / 2);
+    CHECK(occurrences("\"ph\": \"B\"") == occurrences("\"ph\": \"E\""));
+    CHECK(occurrences("\"name\": \"draw\"") == 2);
+    CHECK(occurrences("\"text\": \"Traced \\\"line\\\" ÀÉ\"") == 1);
+    CHECK(occurrences("\"code_point\": \"U+00C0\"") >= 1);
+    CHECK(occurrences("\"cat\": \"kerning\"") > 0);
+    CHECK(occurrences("\"cat\": \"blitting\"") > 0);
+}
+#endif
+
+static std::vector<std::string> drainedMessages;
+
+static void collectMessage(font_log::Level, const char *message) {
+    drainedMessages.emplace_back(message);
+}
+
+TEST_CASE("TTF unknown code points are counted instead of logged each time", "[ttf][log]") {
+    TTFNotoSansLight fontData;
+    Font font(fontData, 14);
+
+    font_log::setSink(collectMessage);
+    font_log::drain();
+    drainedMessages.clear();
+
+    for (int i = 0; i < 20; i++) {
+        CHECK(font.translate(U'\u0E01') == font.translate(UNKNOWN_CODEPOINT));
+    }
+    for (int i = 0; i < 5; i++) {
+        CHECK(font.translate(U'\u0E02') == font.translate(UNKNOWN_CODEPOINT));
+    }
+    font_log::drain();
+    font_log::setSink(nullptr);
+
+    REQUIRE(!drainedMessages.empty());
+    CHECK(drainedMessages.back() == "Unknown code points received: U+0E01 (20), U+0E02 (5)");
+#if CONFIG_TINYFONT_DEFERRED_LOG
+    // The first occurrence of each one, unless the warnings of the unknown code points of the
+    // previous tests exhausted their rate, then the summary
+    REQUIRE(drainedMessages.size() <= 3);
+    for (size_t i = 0; i + 1 < drainedMessages.size(); i++) {
+        CHECK(drainedMessages[i].rfind("Unknown Code Point received: U+00e0", 0) == 0);
+    }
+#endif
+}
+
+#if !CONFIG_TINYFONT_DEFERRED_LOG
+TEST_CASE("TTF unknown code points are printed once their slots are all in use", "[ttf][log]") {
+    TTFNotoSansLight fontData;
+    Font font(fontData, 14);
+
+    font_log::setSink(collectMessage);
+    font_log::drain();
+    drainedMessages.clear();
+
+    // Without deferred logging, drain() is not needed to count more code points than slots
+    for (char32_t codePoint = U'\u0E01'; codePoint <= U'\u0E11'; codePoint++) {
+        (void)font.translate(codePoint);
+    }
+    REQUIRE(drainedMessages.size() == 1);
+    CHECK(drainedMessages[0].rfind("Unknown code points received: U+0E01 (1), U+0E02 (1),", 0) ==
+          0);
+    CHECK(drainedMessages[0].find("U+0E10 (1)") != std::string::npos);
+
+    drainedMessages.clear();
+    font_log::drain();
+    font_log::setSink(nullptr);
+    REQUIRE(drainedMessages.size() == 1);
+    CHECK(drainedMessages[0] == "Unknown code points received: U+0E11 (1)");
+}
+#endif
+
+#if CONFIG_TINYFONT_DEFERRED_LOG
+TEST_CASE("Deferred log formats the messages when drained, limiting their rate", "[ttf][log]") {
+    font_log::setSink(collectMessage);
+    font_log::drain();
+    drainedMessages.clear();
+
+    for (int i = 0; i < 50; i++) {
+        LOGI("Message %d of %s: %5.2f %c %x %" PRId64 " %u%%", i, std::string("the test").c_str(),
+             3.14159, 'A', -1, int64_t(-5), uint8_t(200));
+    }
+    CHECK(drainedMessages.empty());
+    CHECK(font_log::drain() == font_log::RATE_LIMIT);
+    REQUIRE(drainedMessages.size() == font_log::RATE_LIMIT);
+    CHECK(drainedMessages[0] == "Message 0 of the test:  3.14 A ffffffff -5 200%");
+    CHECK(drainedMessages[9] == "Message 9 of the test:  3.14 A ffffffff -5 200%");
+
+    // The first message of the next window tells the count of the suppressed ones
+    static uint32_t now = 5000;
+    font_log::setClock([] { return now; });
+    font_log::Site site;
+    uint32_t suppressed;
+    for (int i = 0; i < 15; i++) {
+        site.admit(suppressed);
+    }
+    now += font_log::RATE_WINDOW - 1;
+    font_log::record(site, font_log::Level::INFO, "Still suppressed");
+    now += 1;
+    font_log::record(site, font_log::Level::INFO, "After a pause");
+    font_log::setClock(nullptr);
+    drainedMessages.clear();
+    font_log::drain();
+    REQUIRE(drainedMessages.size() == 1);
+    CHECK(drainedMessages[0] == "After a pause (6 similar messages suppressed)");
+
+    // Messages of more sites than the ring holds: the oldest ones are lost
+    std::vector<font_log::Site> sites(font_log::RING_SIZE + 8);
+    for (size_t i = 0; i < sites.size(); i++) {
+        font_log::record(sites[i], font_log::Level::WARNING, "Site %zu", i);
+    }
+    drainedMessages.clear();
+    CHECK(font_log::drain() == font_log::RING_SIZE + 1);
+    font_log::setSink(nullptr);
+    REQUIRE(drainedMessages.size() == font_log::RING_SIZE + 1);
+    CHECK(drainedMessages[0] == "8 log messages lost");
+    CHECK(drainedMessages[1] == "Site 8");
+    CHECK(drainedMessages.back() == "Site " + std::to_string(sites.size() - 1));
+}
+#endif
+
+TEST_CASE("TTF sup/sub size switches scale like a font of that size", "[ttf][supsub]") {
+    TTFNotoSansLight fontData;
+    Font font(fontData, 16);
+    Font smallFont(fontData, 16 - SUP_SUB_FONT_DOWNSIZING);
+
+    auto sameMeasures = [](Font &a, Font &b) {
+        bool same = a.lineHeight() == b.lineHeight();
+        for (GlyphCode glyphCode = 30; glyphCode < 90; glyphCode++) {
+            TTFCache::Measure ma, mb;
+            REQUIRE(a.getMeasureForCache(glyphCode, ma));
+            REQUIRE(b.getMeasureForCache(glyphCode, mb));
+            same = same && (ma.width == mb.width) && (ma.metrics.xoff == mb.metrics.xoff) &&
+                   (ma.metrics.yoff == mb.metrics.yoff) &&
+                   (ma.metrics.advance == mb.metrics.advance);
+        }
+        return same;
+    };
+
+    Font normalFont(fontData, 16);
+    for (int i = 0; i < 3; i++) {
+        font.setSupSubFontSize();
+        CHECK(sameMeasures(font, smallFont));
+        font.setNormalFontSize();
+        CHECK(sameMeasures(font, normalFont));
+    }
+}
+
+TEST_CASE("TTF fonts of several sizes share the faces of their FontData", "[ttf][faces]") {
+    const std::string text = "Shared faces, separate sizes";
+
+    auto render = [&text](Font &font) { return renderLine(font, text, 500, 80); };
+
+    TTFNotoSansLight smallData, bigData;
+    Font smallAlone(smallData, 12);
+    Font bigAlone(bigData, 24);
+    auto smallRef = render(smallAlone);
+    auto bigRef = render(bigAlone);
+
+    TTFNotoSansLight fontData;
+    std::vector<Font> fonts;
+    fonts.emplace_back(fontData, 12);
+    fonts.emplace_back(fontData, 24); // Moves the first Font
+    REQUIRE(fonts[0].isInitialized());
+    REQUIRE(fonts[1].isInitialized());
+
+    for (int i = 0; i < 2; i++) {
+        CHECK(fonts[0].lineHeight() == smallAlone.lineHeight());
+        CHECK(fonts[1].lineHeight() == bigAlone.lineHeight());
+        CHECK((render(fonts[0]) == smallRef));
+        CHECK((render(fonts[1]) == bigRef));
+        CHECK(fonts[0].getTextWidth(text) == smallAlone.getTextWidth(text));
+        CHECK(fonts[1].getTextWidth(text) == bigAlone.getTextWidth(text));
+    }
+}
+
+TEST_CASE("TTF private face is only opened by a private-use code point", "[ttf][faces]") {
+    TTFNotoSansLight fontData;
+    Font font(fontData, 20);
+    REQUIRE(font.isInitialized());
+
+    renderLine(font, "Plain ASCII text", 300, 60);
+    CHECK(font.getTextWidth("Plain ASCII text") > 0);
+    CHECK_FALSE(font.isPrivateFaceOpen());
+
+    // U+E05E, the glyph also used for unknown code points
+    const std::string privateText = "\xEE\x81\x9E";
+    std::vector<uint8_t> out = renderLine(font, privateText, 300, 60);
+    CHECK(font.isPrivateFaceOpen());
+    CHECK(font.getTextWidth(privateText) > 0);
+    CHECK(std::count(out.begin(), out.end(), 255) < static_cast<std::ptrdiff_t>(out.size()));
+}
+
+TEST_CASE("TTF font files are used in place", "[ttf][file]") {
+    TTFFileFontData fileData(FONTS_DIR "/IBMFFonts/NotoSans-Light.ttf",
+                             FONTS_DIR "/TTFFonts/SolPrivate-Light.ttf");
+    REQUIRE(fileData.isOpen());
+    Font font(fileData, 20);
+    REQUIRE(font.isInitialized());
+    CHECK(fileData.getFace()->stream->base == fileData.getData());
+
+    std::vector<uint8_t> out = renderLine(font, "Mapped font file", 400, 100);
+    CHECK(std::count(out.begin(), out.end(), 255) < static_cast<std::ptrdiff_t>(out.size()));
+
+    // The private font file is the embedded one: same private glyph
+    const std::string privateText = "\xEE\x81\x9E";
+    TTFNotoSansLight embeddedData;
+    Font embedded(embeddedData, 20);
+    out = renderLine(font, privateText, 400, 100);
+    CHECK(font.isPrivateFaceOpen());
+    CHECK((out == renderLine(embedded, privateText, 400, 100)));
+
+    TTFFileFontData missingData(FONTS_DIR "/TTFFonts/Missing.ttf");
+    CHECK_FALSE(missingData.isOpen());
+    Font missing(missingData, 20);
+    CHECK_FALSE(missing.isInitialized());
+}
+
+TEST_CASE("TTF streamed font reads only the blocks in use", "[ttf][file][stream]") {
+    const char *path = FONTS_DIR "/IBMFFonts/NotoSans-Light.ttf";
+    const std::string text = "Streamed fonts: only the glyphs in use are read.";
+
+    auto render = [&text](FontData &fontData) {
+        Font font(fontData, 20);
+        REQUIRE(font.isInitialized());
+        return renderLine(font, text, 700, 100);
+    };
+
+    TTFFileFontData fileData(path);
+    auto ref = render(fileData);
+
+    TTFStreamFontData streamData(path);
+    REQUIRE(streamData.isOpen());
+    CHECK((render(streamData) == ref));
+
+    const TTFBlockStream &stream = streamData.getBlockStream();
+    INFO("Read " << stream.getSourceBytes() << " of " << stream.getSize() << " bytes");
+    CHECK(stream.getSourceBytes() < stream.getSize() / 2);
+    CHECK(stream.getHitRate() > 0.5F);
+
+    // Same rendering when the blocks keep being evicted
+    TTFStreamFontData smallCache(path, nullptr, 256, 2);
+    CHECK((render(smallCache) == ref));
+    CHECK(smallCache.getBlockStream().getMissCount() > stream.getMissCount());
+
+    CHECK(smallCache.getDataHash() == streamData.getDataHash());
+
+    TTFStreamFontData missingData(FONTS_DIR "/TTFFonts/Missing.ttf");
+    CHECK_FALSE(missingData.isOpen());
+    CHECK_FALSE(Font(missingData, 20).isInitialized());
+}
+
+TEST_CASE("TTF FreeType memory is accounted per phase", "[ttf][memory]") {
+    auto live = [](TTFMemoryPhase phase) { return TTFMemory::getStats(phase).liveBytes; };
+
+    // The FreeType library, created by the first FontData, is never done
+    { TTFNotoSansLight libraryUser; }
+
+    TTFMemory::resetStats();
+    const uint32_t liveBefore = TTFMemory::getTotalStats().liveBytes;
+    const uint32_t openBefore = live(TTFMemoryPhase::FACE_OPEN);
+    {
+        TTFNotoSansLight fontData;
+        Font font(fontData, 20);
+        REQUIRE(font.isInitialized());
+        CHECK(live(TTFMemoryPhase::FACE_OPEN) > openBefore);
+
+        renderLine(font, "Accounted allocations", 500, 100);
+
+        CHECK(TTFMemory::getStats(TTFMemoryPhase::FACE_OPEN).allocCount > 0);
+        CHECK(TTFMemory::getStats(TTFMemoryPhase::LOAD_GLYPH).allocCount > 0);
+        CHECK(TTFMemory::getStats(TTFMemoryPhase::RENDER).allocCount > 0);
+        CHECK(TTFMemory::getStats(TTFMemoryPhase::RENDER).peakBytes > 0);
+        CHECK(TTFMemory::getTotalStats().peakBytes >= TTFMemory::getTotalStats().liveBytes);
+    }
+
+    // Everything FreeType allocated for the faces and glyphs is back
+    CHECK(TTFMemory::getTotalStats().liveBytes == liveBefore);
+#if CONFIG_TINYFONT_TTF_MEMORY_POOL
+    CHECK(TTFMemory::getPoolBytes() > 0);
+#endif
+}
+
+TEST_CASE("TTF strike draws the glyphs of FreeType", "[ttf][strike]") {
+    const std::string line = "Fine AVATAR office: \xC3\x80\xC3\x89\xC3\x8E 0123 \xEE\x81\x9E ~";
+
+    std::vector<uint8_t> built;
+    {
+        TTFNotoSansLight fontData;
+        TTFStrikeWriter writer(fontData);
+        writer.addCodePoints(0x20, 0x7E);
+        writer.addCodePoints(0xC0, 0xFF);
+        writer.addCodePoints(0xE05E, 0xE05E);
+        for (int ptSize : {16, 18}) {
+            REQUIRE(writer.addSize(ptSize, PixelResolution::EIGHT_BITS));
+            REQUIRE(writer.addSize(ptSize, PixelResolution::ONE_BIT));
+        }
+        REQUIRE(writer.build(built));
+    }
+
+    // The strike is used in place: 4 bytes aligned
+    std::vector<uint32_t> aligned((built.size() + 3) / 4);
+    std::memcpy(aligned.data(), built.data(), built.size());
+    TTFStrikeFontData strikeData(reinterpret_cast<const uint8_t *>(aligned.data()),
+                                 static_cast<uint32_t>(built.size()));
+    REQUIRE(strikeData.isLoaded());
+
+    auto render = [&line](Font &font) { return renderLine(font, line, 600); };
+
+    TTFNotoSansLight fontData;
+    CHECK(strikeData.getDataHash() == fontData.getDataHash());
+
+    for (auto resolution : {PixelResolution::EIGHT_BITS, PixelResolution::ONE_BIT}) {
+        Font reference(fontData, 18);
+        Font font(strikeData, 18);
+        REQUIRE(font.isInitialized());
+        CHECK(font.isUsingStrike());
+        reference.setFontPixelResolution(resolution);
+        font.setFontPixelResolution(resolution);
+
+        CHECK(font.lineHeight() == reference.lineHeight());
+        CHECK(font.getTextWidth(line) == reference.getTextWidth(line));
+        CHECK((render(font) == render(reference)));
+
+        reference.setSupSubFontSize();
+        font.setSupSubFontSize();
+        CHECK((render(font) == render(reference)));
+    }
+    CHECK(strikeData.getFace() == nullptr);
+
+    // A size that is not in the strike
+    Font missing(strikeData, 12);
+    CHECK_FALSE(missing.isInitialized());
+
+    // The glyph bitmaps are packed
+    const TTFStrike *strike = strikeData.getStrike();
+    const TTFStrike::SizeEntry *size = strike->findSize(18);
+    REQUIRE(size != nullptr);
+    uint32_t packed = 0;
+    uint32_t raw = 0;
+    auto glyphs = reinterpret_cast<const TTFStrike::GlyphEntry *>(built.data() +
+                                                                 size->glyphs[0].offset);
+    for (uint32_t i = 0; i < size->glyphs[0].count; i++) {
+        packed += glyphs[i].dataLength;
+        raw += glyphs[i].width * glyphs[i].height;
+    }
+    CHECK(packed < raw);
+
+    // Not for this display resolution
+    auto header = reinterpret_cast<TTFStrike::Header *>(aligned.data());
+    header->dpi++;
+    TTFStrike other;
+    CHECK_FALSE(other.load(reinterpret_cast<const uint8_t *>(aligned.data()),
+                           static_cast<uint32_t>(built.size())));
+}
+
+TEST_CASE("TTF direct rendering of large sizes matches the cached glyphs", "[ttf][direct]") {
+    const std::string text = "Headline: Quick brown fox";
+    const Dim dim(600, 150);
+    // Around the reference canvas, as copyBitmap() does not clip
+    const int margin = 200;
+    const int marginX = 1500;
+
+    for (PixelResolution res : {PixelResolution::EIGHT_BITS, PixelResolution::SIXTEEN_BITS}) {
+        int bytesPerPixel = (res == PixelResolution::SIXTEEN_BITS) ? 2 : 1;
+
+        auto render = [&text, res, bytesPerPixel](Dim dim, Pos offset, int directRenderSize,
+                                                  uint32_t &misses) {
+            TTFNotoSansLight fontData;
+            Font font(fontData, 60);
+            (void)font.setDisplayPixelResolution(res);
+            font.setDirectRenderSize(directRenderSize);
+
+            Bitmap canvas;
+            canvas.dim = dim;
+            std::vector<uint8_t> out(
+                static_cast<size_t>(canvas.dim.width * canvas.dim.height * bytesPerPixel), 255);
+            canvas.pixels = out.data();
+            // Text starting left of the canvas and going past its right and bottom sides
+            font.drawSingleLineOfText(canvas, Pos(offset.x + 10, offset.y), text, false);
+            font.drawSingleLineOfText(canvas, Pos(offset.x - 25, offset.y + 40), text, true);
+
+            misses = fontData.cache.getMissCount();
+            return out;
+        };
+
+        INFO("Display pixel resolution " << int(res));
+        uint32_t cachedMisses = 0, directMisses = 0;
+        Dim refDim(dim.width + marginX * 2, dim.height + margin * 2);
+        auto cached = render(refDim, Pos(marginX, margin), 0, cachedMisses);
+        auto direct = render(dim, Pos(0, 0), 48, directMisses);
+
+        std::vector<uint8_t> expected;
+        for (int row = 0; row < dim.height; row++) {
+            auto from = cached.begin() + ((row + margin) * refDim.width + marginX) * bytesPerPixel;
+            expected.insert(expected.end(), from, from + dim.width * bytesPerPixel);
+        }
+        CHECK((direct == expected));
+        CHECK(directMisses < cachedMisses);
+    }
+}
+
+TEST_CASE("TTF line end is past glyphs wider than 255 pixels", "[ttf][direct]") {
+    TTFNotoSansLight fontData;
+    Font font(fontData, 180);
+
+    for (int directRenderSize : {48, 0}) {
+        INFO("Direct render size " << directRenderSize);
+        font.setDirectRenderSize(directRenderSize);
+        std::optional<TTFCache::Measure> measure = font.getCachedMeasure(font.translate('W'));
+        REQUIRE(measure.has_value());
+        REQUIRE(measure->width > 255);
+
+        int endX = 0;
+        renderLine(font, "W", measure->width + 40, 0, Pos(10, 10), &endX);
+        CHECK(endX == 10 + measure->width);
+    }
+}
+
+TEST_CASE("TTF outline cache serves the glyphs of every size", "[ttf][outlines]") {
+    const std::string text = "Reading sizes: the quick brown fox";
+
+    TTFNotoSansLight fontData;
+    fontData.outlines.setBudget(64 * 1024);
+    FT_Face face = fontData.getFace();
+
+    Bitmap canvas;
+    canvas.dim = Dim(900, 120);
+    std::vector<uint8_t> out(static_cast<size_t>(canvas.dim.width * canvas.dim.height), 255);
+    canvas.pixels = out.data();
+
+    Font first(fontData, 16);
+    first.drawSingleLineOfText(canvas, Pos(0, 0), text, false);
+    uint32_t outlineMisses = fontData.outlines.getMissCount();
+    CHECK(outlineMisses > 0);
+
+    for (int size : {17, 18, 20, 24}) {
+        INFO("TTF size " << size);
+        Font font(fontData, size);
+        uint32_t glyphMisses = fontData.cache.getMissCount();
+        uint32_t outlineHits = fontData.outlines.getHitCount();
+
+        std::fill(out.begin(), out.end(), 255);
+        font.drawSingleLineOfText(canvas, Pos(0, 0), text, false);
+
+        // New glyph bitmaps, all from the outlines already in cache
+        CHECK(fontData.cache.getMissCount() > glyphMisses);
+        CHECK(fontData.outlines.getMissCount() == outlineMisses);
+        CHECK(fontData.outlines.getHitCount() > outlineHits);
+
+        // Same bitmaps and metrics as FreeType unhinted glyphs, measured the same way
+        for (char32_t codePoint = U'a'; codePoint <= U'z'; codePoint++) {
+            GlyphCode glyphCode = font.translate(codePoint);
+            auto glyph = font.getCachedGlyph(glyphCode);
+            REQUIRE(glyph.has_value());
+
+            TTFCache::Measure measure;
+            REQUIRE(font.getMeasureForCache(glyphCode, measure));
+            CHECK(measure.width == glyph.value()->bitmap.dim.width);
+            CHECK(measure.metrics.xoff == glyph.value()->metrics.xoff);
+            CHECK(measure.metrics.yoff == glyph.value()->metrics.yoff);
+            CHECK(measure.metrics.advance == glyph.value()->metrics.advance);
+
+            REQUIRE(FT_Load_Glyph(face, glyphCode, FT_LOAD_NO_HINTING) == 0);
+            REQUIRE(FT_Render_Glyph(face->glyph, FT_RENDER_MODE_NORMAL) == 0);
+            const FT_Bitmap &bitmap = face->glyph->bitmap;
+            REQUIRE(glyph.value()->bitmap.dim.width == int(bitmap.width));
+            REQUIRE(glyph.value()->bitmap.dim.height == int(bitmap.rows));
+            CHECK(glyph.value()->metrics.xoff == -face->glyph->bitmap_left);
+            CHECK(glyph.value()->metrics.yoff == -face->glyph->bitmap_top);
+            for (unsigned row = 0; row < bitmap.rows; row++) {
+                const uint8_t *pixels = glyph.value()->bitmap.pixels;
+                CHECK(std::memcmp(pixels + row * glyph.value()->bitmap.pitch,
+                                  bitmap.buffer + row * bitmap.pitch, bitmap.width) == 0);
+            }
+        }
+        outlineMisses = fontData.outlines.getMissCount();
+    }
+}
+
+TEST_CASE("TTF outline cache stays within its budget", "[ttf][outlines]") {
+    const uint32_t budget = 4 * 1024;
+
+    TTFNotoSansLight fontData;
+    fontData.outlines.setBudget(budget);
+    Font font(fontData, 14);
+
+    CHECK(fontData.cache.prefetch(font, U'!', U'~') > 0);
+    CHECK(fontData.outlines.getEvictCount() > 0);
+    CHECK(fontData.outlines.getAllocatedBytes() <= budget);
+    CHECK(fontData.outlines.getOutlineCount() > 0);
+
+    fontData.outlines.setBudget(0);
+    CHECK(fontData.outlines.getOutlineCount() == 0);
+    CHECK(fontData.outlines.getAllocatedBytes() == 0);
+}
@@ -0,0 +1,421 @@
+// Micro-benchmarks of the hot paths of the font drivers: UTF-8 decoding, code point
+// translation, ligature and kerning programs, glyph decoding and caching, bitmap copies for
+// each pair of font and display pixel resolutions, and whole lines of text.
+//
+// The same source is built for each driver (bench_hot_paths_ibmf, bench_hot_paths_ttf). The
+// results are written as JSON to the file given as argument, so that releases can be
+// compared, and as a table to the standard output.
+//
+// Not a test: build the targets and run them on an idle machine.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "Font.hpp"
+#include "UTF8Iterator.hpp"
+
+#if CONFIG_TINYFONT_IBMF
+#include "IBMFFonts/SolSans_75.h"
+using namespace ibmf_defs;
+static const char *const DRIVER = "ibmf";
+#else
+#include "TTFDriver/TTFNotoSansLight.hpp"
+using namespace ttf_defs;
+static const char *const DRIVER = "ttf";
+#endif
+
+using namespace font_defs;
+
+using Clock = std::chrono::steady_clock;
+
+// Each figure is the best of REPEATS runs, a run calling the benchmark body until it took at
+// least MIN_RUN_TIME.
+static const int REPEATS = 5;
+static const auto MIN_RUN_TIME = std::chrono::milliseconds(20);
+
+static const std::string TEXT = "Voix ambiguë d'un cœur qui, au zéphyr, préfère les jattes de "
+                                "kiwis. The quick brown fox jumps over the lazy dog: 0123456789, "
+                                "«office» — fluffy waffles!";
+
+struct Result {
+    std::string name;
+    std::string variant;
+    int size;
+    const char *unit;
+    double nsPerOp;
+};
+
+static std::vector<Result> results;
+
+// Keeps the compiler from dropping the benchmarked calls
+static volatile uint32_t sink;
+
+/// @brief Time **body**, doing **ops** operations of **unit** per call, and record the result.
+/// **setup** is called, untimed, before each call of **body**.
+static void run(const std::string &name, const std::string &variant, int size, const char *unit,
+                size_t ops, const std::function<void()> &body,
+                const std::function<void()> &setup = nullptr) {
+    double best = 0.0;
+    for (int repeat = 0; repeat < REPEATS; repeat++) {
+        Clock::duration elapsed{};
+        size_t calls = 0;
+        while (elapsed < MIN_RUN_TIME) {
+            if (setup) {
+                setup();
+            }
+            Clock::time_point start = Clock::now();
+            body();
+            elapsed += Clock::now() - start;
+            calls++;
+        }
+        double ns = std::chrono::duration<double, std::nano>(elapsed).count() /
+                    static_cast<double>(calls * ops);
+        best = (repeat == 0) ? ns : std::min(best, ns);
+    }
+    results.push_back({name, variant, size, unit, best});
+    std::printf("%-14s %-18s %4d %12.1f ns/%s\n", name.c_str(), variant.c_str(), size, best, unit);
+}
+
+static auto codePointsOf(const std::string &text) -> std::vector<char32_t> {
+    std::vector<char32_t> codePoints;
+    for (auto iter = UTF8Iterator(text); iter != text.end(); iter++) {
+        codePoints.push_back(*iter);
+    }
+    return codePoints;
+}
+
+static auto resolutionName(PixelResolution resolution) -> std::string {
+    return std::to_string(bitsPerPixel(resolution));
+}
+
+struct Canvas {
+    std::vector<uint8_t> pixels;
+    Bitmap bitmap;
+
+    Canvas(int width, int height, PixelResolution resolution) {
+        bitmap.dim = Dim(width, height);
+        bitmap.pitch = canvasPitch(width, resolution);
+        size_t bytes = static_cast<size_t>(bitmap.pitch) * height;
+        if (resolution == PixelResolution::SIXTEEN_BITS) {
+            bytes *= 2;
+        } else if (resolution == PixelResolution::TWENTYFOUR_BITS) {
+            bytes *= 3;
+        }
+        pixels.assign(bytes, 0xFF);
+        bitmap.pixels = pixels.data();
+    }
+};
+
+static void benchUTF8() {
+    const std::vector<char32_t> codePoints = codePointsOf(TEXT);
+
+    run("utf8_decode", "iterator", 0, "codepoint", codePoints.size(), [] {
+        uint32_t sum = 0;
+        for (auto iter = UTF8Iterator(TEXT); iter != TEXT.end(); iter++) {
+            sum += *iter;
+        }
+        sink = sum;
+    });
+}
+
+#if CONFIG_TINYFONT_IBMF
+
+static void benchLines(Font &font, int size) {
+    const std::vector<char32_t> codePoints = codePointsOf(TEXT);
+
+    run("utf8_decode", "toChar32", size, "codepoint", codePoints.size(), [&font] {
+        uint32_t sum = 0;
+        const char *str = TEXT.c_str();
+        while (*str != '\0') {
+            sum += font.toChar32(&str);
+        }
+        sink = sum;
+    });
+
+    run("text_width", "", size, "line", 1, [&font] { sink = font.getTextWidth(TEXT); });
+
+    for (auto resolution : {PixelResolution::ONE_BIT, PixelResolution::EIGHT_BITS}) {
+        if (!font.setDisplayPixelResolution(resolution)) {
+            continue;
+        }
+        Canvas canvas(font.getTextWidth(TEXT) + 20, font.lineHeight() * 2, resolution);
+        run("draw_line", resolutionName(resolution), size, "line", 1,
+            [&] { sink = font.drawSingleLineOfText(canvas.bitmap, Pos(10, 0), TEXT, false); });
+    }
+    (void)font.setDisplayPixelResolution(PixelResolution::ONE_BIT);
+}
+
+static void benchFace(int faceIndex) {
+    FontData fontData(SOLSANS_75_IBMF, SOLSANS_75_IBMF_LEN);
+    Font font(fontData, faceIndex);
+    IBMFFace *face = fontData.getFace(faceIndex);
+    const int size = face->getFacePtSize();
+
+    const std::vector<char32_t> codePoints = codePointsOf(TEXT);
+    std::vector<GlyphCode> glyphCodes;
+    for (char32_t codePoint : codePoints) {
+        glyphCodes.push_back(fontData.translate(codePoint));
+    }
+
+    run("translate", "", size, "codepoint", codePoints.size(), [&] {
+        uint32_t sum = 0;
+        for (char32_t codePoint : codePoints) {
+            sum += fontData.translate(codePoint);
+        }
+        sink = sum;
+    });
+
+    auto ligKernAll = [&](IBMFFace *theFace) {
+        uint32_t sum = 0;
+        for (size_t i = 1; i < glyphCodes.size(); i++) {
+            GlyphCode glyphCode2 = glyphCodes[i];
+            FIX16 kern = 0;
+            sum += theFace->ligKern(glyphCodes[i - 1], &glyphCode2, &kern) + kern;
+        }
+        sink = sum;
+    };
+
+    // The 8 bits faces only run the programs. The 1 bit ones then compute the optical
+    // kerning of the pairs, kept for the next time they are seen.
+    (void)font.setDisplayPixelResolution(PixelResolution::EIGHT_BITS);
+    run("ligKern", "program", size, "pair", glyphCodes.size() - 1, [&] { ligKernAll(face); });
+    (void)font.setDisplayPixelResolution(PixelResolution::ONE_BIT);
+    run("ligKern", "optical", size, "pair", glyphCodes.size() - 1, [&] { ligKernAll(face); });
+
+    std::unique_ptr<FontData> coldData;
+    run(
+        "ligKern", "optical_cold", size, "pair", glyphCodes.size() - 1,
+        [&] { ligKernAll(coldData->getFace(faceIndex)); },
+        [&] { coldData = std::make_unique<FontData>(SOLSANS_75_IBMF, SOLSANS_75_IBMF_LEN); });
+
+    for (auto resolution : {PixelResolution::ONE_BIT, PixelResolution::EIGHT_BITS}) {
+        if (!font.setDisplayPixelResolution(resolution)) {
+            continue;
+        }
+        run("rle_decode", resolutionName(resolution), size, "glyph", glyphCodes.size(), [&] {
+            for (GlyphCode glyphCode : glyphCodes) {
+                Glyph glyph;
+                if (face->getGlyph(glyphCode, glyph, true)) {
+                    delete[] glyph.bitmap.pixels;
+                }
+            }
+        });
+    }
+    (void)font.setDisplayPixelResolution(PixelResolution::ONE_BIT);
+
+    benchLines(font, size);
+}
+
+static void benchDriver() {
+    FontData fontData(SOLSANS_75_IBMF, SOLSANS_75_IBMF_LEN);
+    for (int faceIndex = 0; faceIndex < fontData.getFaceCount(); faceIndex++) {
+        benchFace(faceIndex);
+    }
+}
+
+#else
+
+static const int SIZES[] = {8, 12, 16, 24, 48};
+
+struct CopyPair {
+    PixelResolution font;
+    PixelResolution display;
+    MonoRendering mono;
+};
+
+static const CopyPair COPY_PAIRS[] = {
+    {PixelResolution::ONE_BIT, PixelResolution::ONE_BIT, MonoRendering::HINTED},
+    {PixelResolution::ONE_BIT, PixelResolution::ONE_BIT, MonoRendering::THRESHOLD},
+    {PixelResolution::ONE_BIT, PixelResolution::ONE_BIT, MonoRendering::ORDERED_DITHER},
+    {PixelResolution::ONE_BIT, PixelResolution::EIGHT_BITS, MonoRendering::HINTED},
+    {PixelResolution::ONE_BIT, PixelResolution::EIGHT_BITS, MonoRendering::ORDERED_DITHER},
+    {PixelResolution::ONE_BIT, PixelResolution::SIXTEEN_BITS, MonoRendering::HINTED},
+    {PixelResolution::ONE_BIT, PixelResolution::TWENTYFOUR_BITS, MonoRendering::HINTED},
+    {PixelResolution::ONE_BIT, PixelResolution::FOUR_BITS, MonoRendering::HINTED},
+    {PixelResolution::EIGHT_BITS, PixelResolution::EIGHT_BITS, MonoRendering::HINTED},
+    {PixelResolution::EIGHT_BITS, PixelResolution::SIXTEEN_BITS, MonoRendering::HINTED},
+    {PixelResolution::EIGHT_BITS, PixelResolution::TWENTYFOUR_BITS, MonoRendering::HINTED},
+    {PixelResolution::EIGHT_BITS, PixelResolution::TWO_BITS, MonoRendering::HINTED},
+    {PixelResolution::EIGHT_BITS, PixelResolution::FOUR_BITS, MonoRendering::HINTED},
+    {PixelResolution::FOUR_BITS, PixelResolution::FOUR_BITS, MonoRendering::HINTED},
+    {PixelResolution::FOUR_BITS, PixelResolution::EIGHT_BITS, MonoRendering::HINTED},
+    {PixelResolution::TWO_BITS, PixelResolution::TWO_BITS, MonoRendering::HINTED},
+};
+
+static auto copyVariant(const CopyPair &pair) -> std::string {
+    std::string variant = resolutionName(pair.font) + "->" + resolutionName(pair.display);
+    if (pair.mono == MonoRendering::THRESHOLD) {
+        variant += " threshold";
+    } else if (pair.mono == MonoRendering::ORDERED_DITHER) {
+        variant += " dither";
+    }
+    return variant;
+}
+
+static auto setResolutions(Font &font, PixelResolution display, PixelResolution fontResolution,
+                           MonoRendering mono) -> bool {
+    if (!font.setDisplayPixelResolution(display)) {
+        return false;
+    }
+    font.setFontPixelResolution(fontResolution);
+    font.setMonoRendering(mono);
+    return font.getFontPixelResolution() == fontResolution;
+}
+
+static void benchCopies(Font &font, int size, const std::vector<GlyphCode> &glyphCodes) {
+    for (const CopyPair &pair : COPY_PAIRS) {
+        if (!setResolutions(font, pair.display, pair.font, pair.mono)) {
+            continue;
+        }
+
+        // The cache does not move its glyphs until the next miss
+        std::vector<Bitmap> bitmaps;
+        for (GlyphCode glyphCode : glyphCodes) {
+            (void)font.getCachedGlyph(glyphCode);
+        }
+        for (GlyphCode glyphCode : glyphCodes) {
+            std::optional<const Glyph *> glyph = font.getCachedGlyph(glyphCode);
+            if (glyph.has_value() && (glyph.value()->bitmap.pixels != nullptr)) {
+                bitmaps.push_back(glyph.value()->bitmap);
+            }
+        }
+
+        // The bitmaps are not clipped to the canvas: they are laid out on a few rows
+        const int width = 1000;
+        const int rowHeight = font.lineHeight() * 2;
+        Canvas canvas(width, rowHeight * 8, pair.display);
+        run("copyBitmap", copyVariant(pair), size, "glyph", bitmaps.size(), [&] {
+            Pos pos(3, 1);
+            for (const Bitmap &bitmap : bitmaps) {
+                if (pos.x + bitmap.dim.width >= width) {
+                    pos = Pos(3, pos.y + rowHeight);
+                }
+                font.benchCopyBitmap(canvas.bitmap, bitmap, pos);
+                pos.x += bitmap.dim.width + 1;
+            }
+        });
+    }
+    (void)setResolutions(font, PixelResolution::EIGHT_BITS, PixelResolution::EIGHT_BITS,
+                         DEFAULT_MONO_RENDERING);
+}
+
+static void benchSize(FontData &fontData, int size) {
+    Font font(fontData, size);
+    (void)setResolutions(font, PixelResolution::EIGHT_BITS, PixelResolution::EIGHT_BITS,
+                         DEFAULT_MONO_RENDERING);
+
+    const std::vector<char32_t> codePoints = codePointsOf(TEXT);
+    std::vector<GlyphCode> glyphCodes;
+    for (char32_t codePoint : codePoints) {
+        GlyphCode glyphCode = font.translate(codePoint);
+        if (glyphCode != SPACE_CODE) {
+            glyphCodes.push_back(glyphCode);
+        }
+    }
+
+    run("utf8_decode", "toChar32", size, "codepoint", codePoints.size(), [&font] {
+        uint32_t sum = 0;
+        const char *str = TEXT.c_str();
+        while (*str != '\0') {
+            sum += font.toChar32(&str);
+        }
+        sink = sum;
+    });
+
+    run("translate", "", size, "codepoint", codePoints.size(), [&] {
+        uint32_t sum = 0;
+        for (char32_t codePoint : codePoints) {
+            sum += font.translate(codePoint);
+        }
+        sink = sum;
+    });
+
+    run("ligKern", "tables", size, "pair", glyphCodes.size() - 1, [&] {
+        uint32_t sum = 0;
+        for (size_t i = 1; i < glyphCodes.size(); i++) {
+            GlyphCode glyphCode2 = glyphCodes[i];
+            FIX16 kern = 0;
+            sum += font.benchLigKern(glyphCodes[i - 1], &glyphCode2, &kern) + kern;
+        }
+        sink = sum;
+    });
+
+    for (auto resolution : {PixelResolution::ONE_BIT, PixelResolution::EIGHT_BITS}) {
+        (void)setResolutions(font, resolution, resolution, MonoRendering::HINTED);
+        auto getAll = [&] {
+            uint32_t sum = 0;
+            for (GlyphCode glyphCode : glyphCodes) {
+                sum += font.getCachedGlyph(glyphCode).has_value();
+            }
+            sink = sum;
+        };
+        run("cache_miss", resolutionName(resolution), size, "glyph", glyphCodes.size(), getAll,
+            [&] { fontData.cache.clear(); });
+        run("cache_hit", resolutionName(resolution), size, "glyph", glyphCodes.size(), getAll);
+    }
+
+    benchCopies(font, size, glyphCodes);
+
+    (void)setResolutions(font, PixelResolution::EIGHT_BITS, PixelResolution::EIGHT_BITS,
+                         DEFAULT_MONO_RENDERING);
+    run("text_width", "", size, "line", 1, [&font] { sink = font.getTextWidth(TEXT); });
+
+    for (auto resolution : {PixelResolution::ONE_BIT, PixelResolution::EIGHT_BITS}) {
+        (void)setResolutions(font, resolution, resolution, MonoRendering::HINTED);
+        Canvas canvas(font.getTextWidth(TEXT) + 20, font.lineHeight() * 2, resolution);
+        run("draw_line", resolutionName(resolution), size, "line", 1,
+            [&] { sink = font.drawSingleLineOfText(canvas.bitmap, Pos(10, 0), TEXT, false); });
+    }
+}
+
+static void benchDriver() {
+    TTFNotoSansLight fontData;
+    if (!fontData.isInitialized()) {
+        std::fprintf(stderr, "Unable to initialize the font data.\n");
+        return;
+    }
+    for (int size : SIZES) {
+        benchSize(fontData, size);
+    }
+}
+
+#endif
+
+static auto writeJSON(const char *path) -> bool {
+    FILE *file = std::fopen(path, "w");
+    if (file == nullptr) {
+        return false;
+    }
+    std::fprintf(file, "{\n  \"driver\": \"%s\",\n  \"results\": [\n", DRIVER);
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result &result = results[i];
+        std::fprintf(file,
+                     "    {\"name\": \"%s\", \"variant\": \"%s\", \"size\": %d, "
+                     "\"unit\": \"%s\", \"ns_per_op\": %.2f}%s\n",
+                     result.name.c_str(), result.variant.c_str(), result.size, result.unit,
+                     result.nsPerOp, (i + 1 < results.size()) ? "," : "");
+    }
+    std::fprintf(file, "  ]\n}\n");
+    return std::fclose(file) == 0;
+}
+
+auto main(int argc, char **argv) -> int {
+    std::string path = (argc > 1) ? argv[1] : std::string("bench_hot_paths_") + DRIVER + ".json";
+
+    benchUTF8();
+    benchDriver();
+
+    if (!writeJSON(path.c_str())) {
+        std::fprintf(stderr, "Unable to write %s.\n", path.c_str());
+        return 1;
+    }
+    std::printf("\nResults written to %s\n", path.c_str());
+    return 0;
+}
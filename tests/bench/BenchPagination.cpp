@@ -0,0 +1,449 @@
+// End-to-end pagination benchmark: the multi-language text of Corpus.txt, with footnotes and
+// private-use symbols, is broken into lines and fixed-size pages with the measuring API, and
+// each page is drawn. Footnotes are set at the bottom of the page of their first reference,
+// in a smaller font.
+//
+// The same source is built for each driver (bench_pagination_ibmf, bench_pagination_ttf), and
+// each display pixel resolution is paginated in two passes: once from a new FontData, then
+// WARM_REPEATS times with whatever the first pass left in the caches. Reported for each pass:
+// pages and glyphs per second, peak heap in use (sampled after each page) and the caches' hit
+// ratios. The results are written as JSON to the file given as argument, and as a table to
+// the standard output.
+//
+// Built with CONFIG_TINYFONT_TRACE (trace_pagination_ibmf, trace_pagination_ttf), the first
+// cold pass is also recorded as a Chrome trace in trace_pagination_<driver>.json. Its timings
+// are then those of the traced code.
+//
+// Not a test: build the targets and run them on an idle machine.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#include "Font.hpp"
+#include "Misc/FontTrace.hpp"
+
+#if CONFIG_TINYFONT_IBMF
+#include "IBMFFonts/SolSans_75.h"
+using namespace ibmf_defs;
+static const char *const DRIVER = "ibmf";
+#else
+#include "TTFDriver/TTFNotoSansLight.hpp"
+using namespace ttf_defs;
+static const char *const DRIVER = "ttf";
+#endif
+
+using namespace font_defs;
+
+using Clock = std::chrono::steady_clock;
+
+static const int PAGE_WIDTH = 600;
+static const int PAGE_HEIGHT = 800;
+static const int MARGIN = 24;
+static const int WARM_REPEATS = 10;
+
+struct Paragraph {
+    std::string text;
+    std::vector<std::string> footnotes;
+};
+
+struct PassResult {
+    std::string config;
+    const char *pass;
+    int pages;
+    uint32_t glyphs;
+    double seconds;
+    size_t peakHeap;
+    double glyphHitRatio;   // < 0 when the driver has no such cache
+    double measureHitRatio; // < 0 when the driver has no such cache
+};
+
+static std::vector<PassResult> results;
+
+#if CONFIG_TINYFONT_TRACE
+static bool traced = false;
+#endif
+
+// Start the trace of the first cold pass of a trace build.
+static void startTrace([[maybe_unused]] const char *pass) {
+#if CONFIG_TINYFONT_TRACE
+    if (!traced && (pass[0] == 'c')) {
+        font_trace::start();
+    }
+#endif
+}
+
+static void stopTrace() {
+#if CONFIG_TINYFONT_TRACE
+    if (font_trace::isRecording()) {
+        traced = true;
+        font_trace::stop((std::string("trace_pagination_") + DRIVER + ".json").c_str());
+    }
+#endif
+}
+
+// Heap bytes in use, including the large blocks mapped apart, or 0 when the C library does not
+// report them.
+static auto heapInUse() -> size_t {
+#if defined(__GLIBC__)
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+#else
+    return 0;
+#endif
+}
+
+static auto loadCorpus(const char *path) -> std::vector<Paragraph> {
+    std::vector<Paragraph> paragraphs;
+    std::ifstream file(path);
+    std::string line;
+    std::string text;
+
+    auto endParagraph = [&]() {
+        if (text.empty()) {
+            return;
+        }
+        if ((text[0] == '^') && !paragraphs.empty()) {
+            paragraphs.back().footnotes.push_back(text.substr(1));
+        } else {
+            paragraphs.push_back({text, {}});
+        }
+        text.clear();
+    };
+
+    while (std::getline(file, line)) {
+        if (!line.empty() && (line[0] == '#')) {
+            continue;
+        }
+        if (line.empty()) {
+            endParagraph();
+        } else {
+            text += text.empty() ? line : " " + line;
+        }
+    }
+    endParagraph();
+    return paragraphs;
+}
+
+/// @brief Greedy line breaking of **text** at the spaces, each word measured with **font**.
+static auto breakLines(Font &font, const std::string &text, int width)
+    -> std::vector<std::string> {
+    std::vector<std::string> lines;
+    std::string line;
+    int lineWidth = 0;
+    const int spaceWidth = font.getTextWidth(" ");
+
+    size_t start = 0;
+    while (start < text.size()) {
+        size_t end = text.find(' ', start);
+        if (end == std::string::npos) {
+            end = text.size();
+        }
+        if (end > start) {
+            std::string word = text.substr(start, end - start);
+            int wordWidth = font.getTextWidth(word);
+            if (!line.empty() && (lineWidth + spaceWidth + wordWidth > width)) {
+                lines.push_back(line);
+                line.clear();
+                lineWidth = 0;
+            }
+            if (!line.empty()) {
+                line += ' ';
+                lineWidth += spaceWidth;
+            }
+            line += word;
+            lineWidth += wordWidth;
+        }
+        start = end + 1;
+    }
+    if (!line.empty()) {
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+/// @brief A page canvas, allocated before the heap baseline of the measures.
+struct Page {
+    std::vector<uint8_t> pixels;
+    Bitmap canvas{};
+
+    explicit Page(PixelResolution resolution) {
+        canvas.dim = Dim(PAGE_WIDTH, PAGE_HEIGHT);
+        canvas.pitch = canvasPitch(PAGE_WIDTH, resolution);
+        pixels.assign(static_cast<size_t>(canvas.pitch) * PAGE_HEIGHT, 0xFF);
+        canvas.pixels = pixels.data();
+    }
+};
+
+class Paginator {
+    Font &body_;
+    Font &notes_;
+    Page &page_;
+
+    int y_{MARGIN};
+    int notesHeight_{0};
+    std::vector<std::string> pageNotes_;
+
+    int pages_{0};
+    uint32_t glyphs_{0};
+    size_t peakHeap_{0};
+
+    [[nodiscard]] auto bottom() const -> int { return PAGE_HEIGHT - MARGIN - notesHeight_; }
+
+    // Height the footnote lines take at the bottom of the current page, with the space
+    // separating them from the body for the first ones.
+    [[nodiscard]] auto notesHeight(size_t lineCount) const -> int {
+        if (lineCount == 0) {
+            return 0;
+        }
+        int gap = pageNotes_.empty() ? notes_.lineHeight() / 2 : 0;
+        return gap + static_cast<int>(lineCount) * notes_.lineHeight();
+    }
+
+    void drawLine(Font &font, const std::string &line, int y) {
+        font.drawSingleLineOfText(page_.canvas, Pos(MARGIN, y), line, false);
+        for (char c : line) {
+            glyphs_ += ((c & 0xC0) != 0x80) && (c != ' ') ? 1 : 0;
+        }
+    }
+
+    void endPage() {
+        int y = PAGE_HEIGHT - MARGIN - static_cast<int>(pageNotes_.size()) * notes_.lineHeight();
+        for (const std::string &line : pageNotes_) {
+            drawLine(notes_, line, y);
+            y += notes_.lineHeight();
+        }
+
+        pages_++;
+        peakHeap_ = std::max(peakHeap_, heapInUse());
+
+        std::memset(page_.pixels.data(), 0xFF, page_.pixels.size());
+        y_ = MARGIN;
+        notesHeight_ = 0;
+        pageNotes_.clear();
+    }
+
+public:
+    Paginator(Font &body, Font &notes, Page &page) : body_(body), notes_(notes), page_(page) {}
+
+    void paginate(const std::vector<Paragraph> &paragraphs) {
+        const int width = PAGE_WIDTH - 2 * MARGIN;
+        const int lineHeight = body_.lineHeight();
+
+        for (const Paragraph &paragraph : paragraphs) {
+            std::vector<std::string> lines = breakLines(body_, paragraph.text, width);
+            std::vector<std::string> noteLines;
+            for (const std::string &footnote : paragraph.footnotes) {
+                for (std::string &line : breakLines(notes_, footnote, width)) {
+                    noteLines.push_back(std::move(line));
+                }
+            }
+
+            // The footnotes go with the first line of their paragraph
+            if ((y_ > MARGIN) && (y_ + lineHeight > bottom() - notesHeight(noteLines.size()))) {
+                endPage();
+            }
+            notesHeight_ += notesHeight(noteLines.size());
+            pageNotes_.insert(pageNotes_.end(), noteLines.begin(), noteLines.end());
+
+            for (const std::string &line : lines) {
+                if ((y_ > MARGIN) && (y_ + lineHeight > bottom())) {
+                    endPage();
+                }
+                drawLine(body_, line, y_);
+                y_ += lineHeight;
+            }
+            y_ += lineHeight / 2;
+        }
+
+        if ((y_ > MARGIN) || !pageNotes_.empty()) {
+            endPage();
+        }
+    }
+
+    [[nodiscard]] auto getPages() const -> int { return pages_; }
+    [[nodiscard]] auto getGlyphs() const -> uint32_t { return glyphs_; }
+    [[nodiscard]] auto getPeakHeap() const -> size_t { return peakHeap_; }
+};
+
+static void report(const PassResult &result) {
+    results.push_back(result);
+    std::printf("%-16s %-5s %5d %9.1f %11.0f %10zu", result.config.c_str(), result.pass,
+                result.pages, result.pages / result.seconds, result.glyphs / result.seconds,
+                result.peakHeap);
+    if (result.glyphHitRatio >= 0.0) {
+        std::printf(" %8.3f %8.3f", result.glyphHitRatio, result.measureHitRatio);
+    }
+    std::printf("\n");
+}
+
+#if CONFIG_TINYFONT_IBMF
+
+static const int BODY_FACE = 1;
+static const int NOTES_FACE = 0;
+
+static void paginateAt(const std::vector<Paragraph> &paragraphs, PixelResolution resolution) {
+    const std::string config = (resolution == PixelResolution::ONE_BIT) ? "1 bit" : "8 bits";
+    Page page(resolution);
+    const size_t baseline = heapInUse();
+
+    FontData fontData(SOLSANS_75_IBMF, SOLSANS_75_IBMF_LEN);
+    Font body(fontData, BODY_FACE);
+    Font notes(fontData, NOTES_FACE);
+    if (!body.setDisplayPixelResolution(resolution) ||
+        !notes.setDisplayPixelResolution(resolution)) {
+        return;
+    }
+
+    for (const char *pass : {"cold", "warm"}) {
+        Paginator paginator(body, notes, page);
+        startTrace(pass);
+        Clock::time_point start = Clock::now();
+        for (int i = (pass[0] == 'c') ? WARM_REPEATS - 1 : 0; i < WARM_REPEATS; i++) {
+            paginator.paginate(paragraphs);
+        }
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        stopTrace();
+
+        // IBMF glyphs are decoded on each use: its only cache is the optical kerning one
+        report({config, pass, paginator.getPages(), paginator.getGlyphs(), seconds,
+                std::max(paginator.getPeakHeap(), baseline) - baseline, -1.0, -1.0});
+    }
+}
+
+static void paginateAll(const std::vector<Paragraph> &paragraphs) {
+    for (auto resolution : {PixelResolution::ONE_BIT, PixelResolution::EIGHT_BITS}) {
+        paginateAt(paragraphs, resolution);
+    }
+}
+
+#else
+
+static const int BODY_SIZE = 12;
+static const int NOTES_SIZE = 9;
+
+struct Config {
+    const char *name;
+    PixelResolution resolution;
+    MonoRendering mono;
+};
+
+static const Config CONFIGS[] = {
+    {"1 bit hinted", PixelResolution::ONE_BIT, MonoRendering::HINTED},
+    {"1 bit dithered", PixelResolution::ONE_BIT, MonoRendering::ORDERED_DITHER},
+    {"2 bits", PixelResolution::TWO_BITS, MonoRendering::HINTED},
+    {"4 bits", PixelResolution::FOUR_BITS, MonoRendering::HINTED},
+    {"8 bits", PixelResolution::EIGHT_BITS, MonoRendering::HINTED},
+};
+
+static auto ratio(uint32_t hits, uint32_t misses) -> double {
+    return (hits + misses == 0) ? 0.0 : static_cast<double>(hits) / (hits + misses);
+}
+
+static auto setResolution(Font &font, const Config &config) -> bool {
+    if (!font.setDisplayPixelResolution(config.resolution)) {
+        return false;
+    }
+    font.setFontPixelResolution(config.resolution);
+    font.setMonoRendering(config.mono);
+    return font.getFontPixelResolution() == config.resolution;
+}
+
+static void paginateAt(const std::vector<Paragraph> &paragraphs, const Config &config) {
+    Page page(config.resolution);
+    const size_t baseline = heapInUse();
+
+    TTFNotoSansLight fontData;
+    Font body(fontData, BODY_SIZE);
+    Font notes(fontData, NOTES_SIZE);
+    if (!setResolution(body, config) || !setResolution(notes, config)) {
+        return;
+    }
+
+    for (const char *pass : {"cold", "warm"}) {
+        const TTFCache &cache = fontData.cache;
+        uint32_t hits = cache.getHitCount();
+        uint32_t misses = cache.getMissCount();
+        uint32_t measureHits = cache.getMeasureHitCount();
+        uint32_t measureMisses = cache.getMeasureMissCount();
+
+        Paginator paginator(body, notes, page);
+        startTrace(pass);
+        Clock::time_point start = Clock::now();
+        for (int i = (pass[0] == 'c') ? WARM_REPEATS - 1 : 0; i < WARM_REPEATS; i++) {
+            paginator.paginate(paragraphs);
+        }
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        stopTrace();
+
+        report({config.name, pass, paginator.getPages(), paginator.getGlyphs(), seconds,
+                std::max(paginator.getPeakHeap(), baseline) - baseline,
+                ratio(cache.getHitCount() - hits, cache.getMissCount() - misses),
+                ratio(cache.getMeasureHitCount() - measureHits,
+                      cache.getMeasureMissCount() - measureMisses)});
+    }
+}
+
+static void paginateAll(const std::vector<Paragraph> &paragraphs) {
+    for (const Config &config : CONFIGS) {
+        paginateAt(paragraphs, config);
+    }
+}
+
+#endif
+
+static auto writeJSON(const char *path) -> bool {
+    FILE *file = std::fopen(path, "w");
+    if (file == nullptr) {
+        return false;
+    }
+    std::fprintf(file, "{\n  \"driver\": \"%s\",\n  \"results\": [\n", DRIVER);
+    for (size_t i = 0; i < results.size(); i++) {
+        const PassResult &result = results[i];
+        std::fprintf(file,
+                     "    {\"config\": \"%s\", \"pass\": \"%s\", \"pages\": %d, \"glyphs\": %u, "
+                     "\"seconds\": %.6f, \"pages_per_second\": %.2f, \"glyphs_per_second\": %.0f, "
+                     "\"peak_heap_bytes\": %zu",
+                     result.config.c_str(), result.pass, result.pages, result.glyphs,
+                     result.seconds, result.pages / result.seconds,
+                     result.glyphs / result.seconds, result.peakHeap);
+        if (result.glyphHitRatio >= 0.0) {
+            std::fprintf(file,
+                         ", \"glyph_cache_hit_ratio\": %.4f, \"measure_cache_hit_ratio\": %.4f",
+                         result.glyphHitRatio, result.measureHitRatio);
+        }
+        std::fprintf(file, "}%s\n", (i + 1 < results.size()) ? "," : "");
+    }
+    std::fprintf(file, "  ]\n}\n");
+    return std::fclose(file) == 0;
+}
+
+auto main(int argc, char **argv) -> int {
+    std::string path = (argc > 1) ? argv[1] : std::string("bench_pagination_") + DRIVER + ".json";
+
+    std::vector<Paragraph> paragraphs = loadCorpus(CORPUS_PATH);
+    if (paragraphs.empty()) {
+        std::fprintf(stderr, "Unable to read %s.\n", CORPUS_PATH);
+        return 1;
+    }
+
+    std::printf("%-16s %-5s %5s %9s %11s %10s %8s %8s\n", "config", "pass", "pages", "pages/s",
+                "glyphs/s", "heap (B)", "glyph", "measure");
+    paginateAll(paragraphs);
+
+    if (!writeJSON(path.c_str())) {
+        std::fprintf(stderr, "Unable to write %s.\n", path.c_str());
+        return 1;
+    }
+    std::printf("\nResults written to %s\n", path.c_str());
+    return 0;
+}
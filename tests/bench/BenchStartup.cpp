@@ -0,0 +1,76 @@
+// Startup benchmark of the TTF driver: time taken by the Font constructor and memory used by
+// each Font instance, for several point sizes. The private face is only set up by the first
+// private-use code point, so its cost is reported apart.
+//
+// Not a test: build the bench_startup target and run it on an idle machine.
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#include "Font.hpp"
+#include "TTFDriver/TTFNotoSansLight.hpp"
+
+using namespace ttf_defs;
+using namespace font_defs;
+
+using Clock = std::chrono::steady_clock;
+
+static const int ITERATIONS = 200;
+static const int SIZES[] = {8, 12, 16, 24, 36, 48};
+
+// Heap bytes in use, or 0 when the C library does not report them.
+static auto heapInUse() -> size_t {
+#if defined(__GLIBC__)
+    return mallinfo2().uordblks;
+#else
+    return 0;
+#endif
+}
+
+static auto microsSince(Clock::time_point start) -> double {
+    return std::chrono::duration<double, std::micro>(Clock::now() - start).count() / ITERATIONS;
+}
+
+auto main() -> int {
+    TTFNotoSansLight fontData;
+    if (!fontData.isInitialized()) {
+        std::fprintf(stderr, "Unable to initialize the font data.\n");
+        return 1;
+    }
+
+    // The faces are opened by the first Font and shared afterward: keep that one-time cost
+    // out of the per-Font figures.
+    Font warmup(fontData, 12);
+
+    std::printf("sizeof(Font): %zu bytes\n\n", sizeof(Font));
+    std::printf("%6s %14s %14s %16s\n", "size", "ctor (us)", "heap/Font (B)", "private (us)");
+
+    for (int size : SIZES) {
+        std::vector<std::unique_ptr<Font>> fonts;
+        fonts.reserve(ITERATIONS);
+
+        size_t heapBefore = heapInUse();
+        Clock::time_point start = Clock::now();
+        for (int i = 0; i < ITERATIONS; i++) {
+            fonts.push_back(std::make_unique<Font>(fontData, size));
+        }
+        double ctorMicros = microsSince(start);
+        size_t heapPerFont = (heapInUse() - heapBefore) / ITERATIONS;
+
+        start = Clock::now();
+        for (auto &font : fonts) {
+            (void)font->translate(UNKNOWN_CODEPOINT);
+        }
+        double privateMicros = microsSince(start);
+
+        std::printf("%6d %14.2f %14zu %16.2f\n", size, ctorMicros, heapPerFont, privateMicros);
+    }
+
+    return 0;
+}
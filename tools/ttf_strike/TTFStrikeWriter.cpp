@@ -0,0 +1,217 @@
+#if CONFIG_TINYFONT_TTF
+
+#include "TTFStrikeWriter.hpp"
+
+#include <cstring>
+
+namespace {
+
+template <typename T>
+auto append(std::vector<uint8_t> &out, const T *items, std::size_t count) -> uint32_t {
+    auto offset = static_cast<uint32_t>(out.size());
+    auto bytes = reinterpret_cast<const uint8_t *>(items);
+    out.insert(out.end(), bytes, bytes + count * sizeof(T));
+    return offset;
+}
+
+void align(std::vector<uint8_t> &out) {
+    while ((out.size() & 3) != 0) {
+        out.push_back(0);
+    }
+}
+
+} // namespace
+
+void TTFStrikeWriter::addCodePoints(char32_t first, char32_t last) {
+    for (char32_t codePoint = first; codePoint <= last; codePoint++) {
+        codePoints_.insert(codePoint);
+    }
+}
+
+auto TTFStrikeWriter::addSize(int ptSize, PixelResolution resolution) -> bool {
+    if ((ptSize <= SUP_SUB_FONT_DOWNSIZING) || (ptSize > 0xFFFF) ||
+        (TTFStrike::resolutionIndex(resolution) < 0)) {
+        LOGE("Strikes only hold 8 bits and 1 bit glyphs of point sizes above %d.",
+             SUP_SUB_FONT_DOWNSIZING);
+        return false;
+    }
+    sizes_[ptSize].insert(resolution);
+    return true;
+}
+
+auto TTFStrikeWriter::build(std::vector<uint8_t> &strike) -> bool {
+
+    if (sizes_.empty()) {
+        LOGE("No size to render in the strike.");
+        return false;
+    }
+
+    // Glyphs of the code points. The translation does not depend on the size.
+
+    Font first(fontData_, sizes_.begin()->first);
+    if (!first.isInitialized()) {
+        return false;
+    }
+
+    std::vector<TTFStrike::CmapEntry> cmap;
+    std::set<GlyphCode> glyphCodes;
+
+    std::set<char32_t> codePoints = codePoints_;
+    codePoints.insert(UNKNOWN_CODEPOINT);
+    for (char32_t codePoint : codePoints) {
+        GlyphCode glyphCode = first.strikeGlyphCode(codePoint);
+        if (glyphCode != 0) {
+            cmap.push_back({static_cast<uint32_t>(codePoint), glyphCode, 0});
+            glyphCodes.insert(glyphCode);
+        }
+    }
+    glyphCodes.insert(first.strikeUnknownGlyphCode());
+
+    // Ligatures, and the glyphs they produce, up to their closure.
+
+    std::map<uint32_t, GlyphCode> ligatures;
+    for (bool added = true; added;) {
+        added = false;
+        std::set<GlyphCode> produced;
+        for (GlyphCode glyphCode1 : glyphCodes) {
+            for (GlyphCode glyphCode2 : glyphCodes) {
+                GlyphCode result = glyphCode2;
+                FIX16 kern;
+                if (first.strikeLigKern(glyphCode1, &result, &kern)) {
+                    ligatures[(static_cast<uint32_t>(glyphCode1) << 16) | glyphCode2] = result;
+                    if (glyphCodes.count(result) == 0) {
+                        produced.insert(result);
+                    }
+                }
+            }
+        }
+        for (GlyphCode glyphCode : produced) {
+            added = glyphCodes.insert(glyphCode).second || added;
+        }
+    }
+
+    // Layout: header, cmap, ligatures and size entries, then the kerning and glyph tables of
+    // each size, then the glyph bitmaps.
+
+    strike.clear();
+
+    TTFStrike::Header header{};
+    memcpy(header.magic, TTFStrike::MAGIC, sizeof(header.magic));
+    header.version = TTFStrike::VERSION;
+    header.dpi = SCREEN_RES_PER_INCH;
+    header.fontHash = fontData_.getDataHash();
+    append(strike, &header, 1);
+
+    header.cmapCount = cmap.size();
+    header.cmapOffset = append(strike, cmap.data(), cmap.size());
+
+    std::vector<TTFStrike::Ligature> ligatureTable;
+    for (auto [pair, glyphCode] : ligatures) {
+        ligatureTable.push_back({pair, glyphCode, 0});
+    }
+    header.ligatureCount = ligatureTable.size();
+    header.ligatureOffset = append(strike, ligatureTable.data(), ligatureTable.size());
+
+    std::vector<TTFStrike::SizeEntry> sizeTable(sizes_.size());
+    header.sizeCount = sizeTable.size();
+    header.sizeOffset = append(strike, sizeTable.data(), sizeTable.size());
+
+    std::vector<uint8_t> bitmaps;
+    std::vector<uint8_t> rows;
+    auto sizeEntry = sizeTable.begin();
+
+    for (const auto &[ptSize, resolutions] : sizes_) {
+        Font font(fontData_, ptSize);
+        if (!font.isInitialized()) {
+            return false;
+        }
+
+        TTFStrike::SizeEntry &entry = *sizeEntry++;
+        entry = {};
+        entry.ptSize = ptSize;
+        entry.lineHeight = static_cast<int16_t>(font.lineHeight());
+        entry.descender = font.strikeDescender();
+        entry.spaceSize = font.strikeSpaceSize();
+
+        std::vector<TTFStrike::Kern> kerns;
+        for (GlyphCode glyphCode1 : glyphCodes) {
+            for (GlyphCode glyphCode2 : glyphCodes) {
+                GlyphCode result = glyphCode2;
+                FIX16 kern = 0;
+                if (!font.strikeLigKern(glyphCode1, &result, &kern) && (kern != 0)) {
+                    kerns.push_back({(static_cast<uint32_t>(glyphCode1) << 16) | glyphCode2, kern,
+                                     0});
+                }
+            }
+        }
+        entry.kernCount = kerns.size();
+        entry.kernOffset = append(strike, kerns.data(), kerns.size());
+
+        // The 1 bit glyphs of a strike are the hinted ones
+        font.setMonoRendering(MonoRendering::HINTED);
+        for (PixelResolution resolution : resolutions) {
+            font.strikeFontPixelResolution(resolution);
+
+            std::vector<TTFStrike::GlyphEntry> glyphs;
+            for (GlyphCode glyphCode : glyphCodes) {
+                Glyph glyph;
+                if (!font.getGlyphForCache(glyphCode, glyph)) {
+                    continue;
+                }
+
+                const Bitmap &bitmap = glyph.bitmap;
+                uint16_t width = (bitmap.pixels != nullptr) ? bitmap.dim.width : 0;
+                uint16_t height = (bitmap.pixels != nullptr) ? bitmap.dim.height : 0;
+                uint16_t rowBytes = TTFStrike::rowBytes(width, resolution);
+
+                rows.clear();
+                for (int row = 0; row < height; row++) {
+                    const uint8_t *from = bitmap.pixels + row * bitmap.pitch;
+                    rows.insert(rows.end(), from, from + rowBytes);
+                }
+
+                auto dataOffset = static_cast<uint32_t>(bitmaps.size());
+                TTFStrike::packBits(rows.data(), rows.size(), bitmaps);
+
+                glyphs.push_back({.glyphCode = glyphCode,
+                                  .width = width,
+                                  .height = height,
+                                  .advance = glyph.metrics.advance,
+                                  .xoff = glyph.metrics.xoff,
+                                  .yoff = glyph.metrics.yoff,
+                                  .descent = glyph.metrics.descent,
+                                  .reserved = 0,
+                                  .dataOffset = dataOffset,
+                                  .dataLength = static_cast<uint32_t>(bitmaps.size()) -
+                                                dataOffset});
+            }
+
+            TTFStrike::GlyphTable &table = entry.glyphs[TTFStrike::resolutionIndex(resolution)];
+            table.count = glyphs.size();
+            table.offset = append(strike, glyphs.data(), glyphs.size());
+        }
+    }
+
+    // The bitmaps go last: their offsets become relative to the start of the strike.
+
+    align(strike);
+    auto bitmapsOffset = static_cast<uint32_t>(strike.size());
+    strike.insert(strike.end(), bitmaps.begin(), bitmaps.end());
+    align(strike);
+
+    for (TTFStrike::SizeEntry &entry : sizeTable) {
+        for (const TTFStrike::GlyphTable &table : entry.glyphs) {
+            auto glyphs = reinterpret_cast<TTFStrike::GlyphEntry *>(strike.data() + table.offset);
+            for (uint32_t i = 0; i < table.count; i++) {
+                glyphs[i].dataOffset += bitmapsOffset;
+            }
+        }
+    }
+
+    memcpy(strike.data(), &header, sizeof(header));
+    memcpy(strike.data() + header.sizeOffset, sizeTable.data(),
+           sizeTable.size() * sizeof(TTFStrike::SizeEntry));
+    return true;
+}
+
+#endif
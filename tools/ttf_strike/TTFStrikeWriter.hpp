@@ -0,0 +1,46 @@
+#pragma once
+
+#if CONFIG_TINYFONT_TTF
+
+#include <map>
+#include <set>
+#include <vector>
+
+#include "TTFDriver/TTFFont.hpp"
+#include "TTFDriver/TTFStrike.hpp"
+
+#if !CONFIG_TINYFONT_TTF_STRIKE_ACCESS
+#error "TTFStrikeWriter needs CONFIG_TINYFONT_TTF_STRIKE_ACCESS"
+#endif
+
+/**
+ * @brief Builder of TTFStrike bitmap strikes, to be run on a host.
+ *
+ * The glyphs are rendered by the Fonts of **fontData**, through the same FreeType path as
+ * the glyphs of the cache, for the display resolution this code is built with. The kerning
+ * and ligatures come from Font::ligKern() at each size: a Font using the strike lays out
+ * text exactly as a Font using FreeType.
+ */
+class TTFStrikeWriter {
+    FontData &fontData_;
+    std::set<char32_t> codePoints_{};
+
+    // Point sizes, with the resolutions to render each one at
+    std::map<int, std::set<PixelResolution>> sizes_{};
+
+public:
+    explicit TTFStrikeWriter(FontData &fontData) : fontData_(fontData) {}
+
+    /// @brief Add the code points **first** to **last** (inclusive) to the strike.
+    void addCodePoints(char32_t first, char32_t last);
+
+    /// @brief Add **ptSize**, rendered at the 8 bits or 1 bit font pixel **resolution**.
+    /// Call it once per resolution wanted.
+    auto addSize(int ptSize, PixelResolution resolution) -> bool;
+
+    /// @brief Build the strike in **strike**.
+    /// @return false if the font data or a size are not usable.
+    auto build(std::vector<uint8_t> &strike) -> bool;
+};
+
+#endif
@@ -0,0 +1,194 @@
+// Build a TTF bitmap strike (see src/TTFDriver/TTFStrike.hpp) on a host.
+//
+// The glyphs are rendered by the TTF driver itself, for the display DPI this tool is built
+// with (TINYFONT_DISPLAY_DPI, see CMakeLists.txt): a device using the strike draws the
+// same pixels as one running FreeType.
+//
+// Usage:
+//   ttf_strike [options] output
+//
+//   --sizes 12,14,16          point sizes to render. Their sup/sub size (2 points less)
+//                             is added, for setSupSubFontSize()
+//   --resolutions 8,1         font pixel resolutions to render: 8 bits and/or 1 bit
+//   --unicodes U+0020-007E,.. code point ranges, as for tools/ttf_subset.py
+//   --font path.ttf           font file. The embedded NotoSans-Light font by default
+//   --private path.ttf        font file of the private-use code points
+//   --header NAME             write a C++ header with the NAME array instead of a binary
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "TTFDriver/TTFFileFontData.hpp"
+#include "TTFDriver/TTFNotoSansLight.hpp"
+#include "TTFStrikeWriter.hpp"
+
+namespace {
+
+const char *const DEFAULT_UNICODES = "U+0020-007E,U+00A0-017F,U+2000-206F,U+20AC";
+
+void usage() {
+    fprintf(stderr, "Usage: ttf_strike --sizes 12,14 [--resolutions 8,1] [--unicodes "
+                    "U+0020-007E,...]\n"
+                    "                  [--font file.ttf [--private file.ttf]] [--header NAME] "
+                    "output\n");
+}
+
+auto split(const char *list) -> std::vector<std::string> {
+    std::vector<std::string> items;
+    std::string item;
+    for (const char *c = list; *c != '\0'; c++) {
+        if (*c == ',') {
+            items.push_back(item);
+            item.clear();
+        } else if (*c != ' ') {
+            item += *c;
+        }
+    }
+    items.push_back(item);
+    return items;
+}
+
+auto parseCodePoint(std::string text, char32_t &codePoint) -> bool {
+    if ((text.size() > 2) && ((text[0] == 'U') || (text[0] == 'u')) && (text[1] == '+')) {
+        text.erase(0, 2);
+    }
+    char *end = nullptr;
+    unsigned long value = strtoul(text.c_str(), &end, 16);
+    codePoint = static_cast<char32_t>(value);
+    return !text.empty() && (*end == '\0') && (value <= 0x10FFFF);
+}
+
+auto addUnicodes(TTFStrikeWriter &writer, const char *spec) -> bool {
+    for (const std::string &item : split(spec)) {
+        if (item.empty()) {
+            continue;
+        }
+        auto dash = item.find('-');
+        char32_t first;
+        char32_t last;
+        if (!parseCodePoint(item.substr(0, dash), first) ||
+            !parseCodePoint((dash == std::string::npos) ? item : item.substr(dash + 1), last) ||
+            (first > last)) {
+            fprintf(stderr, "Invalid Unicode range: %s\n", item.c_str());
+            return false;
+        }
+        writer.addCodePoints(first, last);
+    }
+    return true;
+}
+
+auto writeBinary(const char *path, const std::vector<uint8_t> &strike) -> bool {
+    FILE *file = fopen(path, "wb");
+    if (file == nullptr) {
+        return false;
+    }
+    bool written = fwrite(strike.data(), 1, strike.size(), file) == strike.size();
+    return (fclose(file) == 0) && written;
+}
+
+auto writeHeader(const char *path, const char *name, const std::vector<uint8_t> &strike) -> bool {
+    FILE *file = fopen(path, "w");
+    if (file == nullptr) {
+        return false;
+    }
+    fprintf(file, "// ----- TTF Bitmap Strike %s -----\n//\n", name);
+    fprintf(file, "// Generated by tools/ttf_strike for %d DPI displays.\n//\n\n",
+            SCREEN_RES_PER_INCH);
+    fprintf(file, "#pragma once\n\n#include <cstdint>\n\n");
+    fprintf(file, "const unsigned int %s_LEN = %zu;\n", name, strike.size());
+    fprintf(file, "alignas(4) const uint8_t %s[] = {", name);
+    for (std::size_t i = 0; i < strike.size(); i++) {
+        fprintf(file, "%s0x%02x,", (i % 16 == 0) ? "\n    " : " ", strike[i]);
+    }
+    fprintf(file, "\n};\n");
+    return fclose(file) == 0;
+}
+
+} // namespace
+
+auto main(int argc, char **argv) -> int {
+    const char *sizes = nullptr;
+    const char *resolutions = "8,1";
+    const char *unicodes = DEFAULT_UNICODES;
+    const char *fontPath = nullptr;
+    const char *privatePath = nullptr;
+    const char *headerName = nullptr;
+    const char *output = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char **option = (strcmp(arg, "--sizes") == 0)         ? &sizes
+                              : (strcmp(arg, "--resolutions") == 0) ? &resolutions
+                              : (strcmp(arg, "--unicodes") == 0)    ? &unicodes
+                              : (strcmp(arg, "--font") == 0)        ? &fontPath
+                              : (strcmp(arg, "--private") == 0)     ? &privatePath
+                              : (strcmp(arg, "--header") == 0)      ? &headerName
+                                                                    : nullptr;
+        if (option != nullptr) {
+            if (++i == argc) {
+                usage();
+                return EXIT_FAILURE;
+            }
+            *option = argv[i];
+        } else if ((output == nullptr) && (arg[0] != '-')) {
+            output = arg;
+        } else {
+            usage();
+            return EXIT_FAILURE;
+        }
+    }
+    if ((sizes == nullptr) || (output == nullptr)) {
+        usage();
+        return EXIT_FAILURE;
+    }
+
+    std::unique_ptr<FontData> fontData;
+    if (fontPath != nullptr) {
+        auto fileFontData = std::make_unique<TTFFileFontData>(fontPath, privatePath);
+        if (!fileFontData->isOpen()) {
+            return EXIT_FAILURE;
+        }
+        fontData = std::move(fileFontData);
+    } else {
+        fontData = std::make_unique<TTFNotoSansLight>();
+    }
+
+    TTFStrikeWriter writer(*fontData);
+    if (!addUnicodes(writer, unicodes)) {
+        return EXIT_FAILURE;
+    }
+
+    for (const std::string &size : split(sizes)) {
+        int ptSize = atoi(size.c_str());
+        for (const std::string &resolution : split(resolutions)) {
+            PixelResolution pixelResolution = (resolution == "1") ? PixelResolution::ONE_BIT
+                                                                  : PixelResolution::EIGHT_BITS;
+            if (((resolution != "1") && (resolution != "8")) ||
+                !writer.addSize(ptSize, pixelResolution) ||
+                !writer.addSize(ptSize - SUP_SUB_FONT_DOWNSIZING, pixelResolution)) {
+                fprintf(stderr, "Invalid size %s or resolution %s\n", size.c_str(),
+                        resolution.c_str());
+                return EXIT_FAILURE;
+            }
+        }
+    }
+
+    std::vector<uint8_t> strike;
+    if (!writer.build(strike)) {
+        return EXIT_FAILURE;
+    }
+
+    bool written = (headerName != nullptr) ? writeHeader(output, headerName, strike)
+                                           : writeBinary(output, strike);
+    if (!written) {
+        fprintf(stderr, "Unable to write %s\n", output);
+        return EXIT_FAILURE;
+    }
+
+    printf("%s: %zu bytes\n", output, strike.size());
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,252 @@
+#!/usr/bin/env python3
+"""Subset an embedded TTF font header to a set of Unicode ranges.
+
+The TTF driver embeds each font as a C++ header (see src/TTFFonts/NotoSans-Light.h):
+the font file in a `data_` byte array, followed by the ligature and kerning tables
+consulted by FontData::ligKern(), all indexed by glyph ID.
+
+This tool reads such a header, keeps only the glyphs needed for the requested code
+points, and writes the header again:
+
+  - the font is subset with fontTools. Glyph IDs are renumbered, so cmap, loca, glyf
+    and hmtx only describe the kept glyphs. The OpenType layout tables (GSUB, GPOS,
+    GDEF) are dropped, as the driver only uses its own tables;
+  - the glyphs produced by the ligatures of kept glyphs are kept as well;
+  - `ligatures_`, `kerns_` and `classesDefs_` entries are renumbered to the new glyph
+    IDs. Entries referring to a dropped glyph are removed. The class kerning matrix
+    `mKerns_` is indexed by class and copied as is.
+
+U+0020 (space) is always kept, as the Font constructor needs it. So is U+E05E, the
+glyph of unknown code points when subsetting the private font.
+
+The header can be subset in place: the full font is restored from git.
+
+Usage:
+  ttf_subset.py --unicodes U+0020-007E,U+00A0-017F input.h output.h
+
+Requires fontTools (pip install fonttools).
+"""
+
+import argparse
+import datetime
+import io
+import re
+import sys
+
+from fontTools import subset
+from fontTools.ttLib import TTFont
+
+ALWAYS_KEPT = [0x0020, 0xE05E]
+PRIVATE_GLYPH_FLAG = 0x8000
+
+
+def parse_unicodes(spec):
+    """Parse 'U+0020-007E,U+00A0,0x2000-0x206F' into a sorted list of code points."""
+    codepoints = set()
+    for item in spec.replace(" ", "").split(","):
+        if not item:
+            continue
+        bounds = [int(re.sub(r"^(U\+|0x)", "", b, flags=re.I), 16) for b in item.split("-")]
+        if len(bounds) == 1:
+            bounds.append(bounds[0])
+        if len(bounds) != 2 or bounds[0] > bounds[1]:
+            raise ValueError(f"invalid Unicode range: {item}")
+        codepoints.update(range(bounds[0], bounds[1] + 1))
+    return sorted(codepoints)
+
+
+def array_body(text, name):
+    """Return the initializer text of the std::array member `name`."""
+    match = re.search(r"std::array<.*?>\s+" + name + r"\s*=\s*\{(.*?)\};", text, re.S)
+    if match is None:
+        raise ValueError(f"{name} not found in the header")
+    return match.group(1)
+
+
+def int_list(body):
+    return [int(v, 0) for v in re.findall(r"-?0x[0-9a-fA-F]+|-?\d+", body)]
+
+
+def parse_header(text):
+    font = {}
+    font["name"] = re.search(r"^\}\s*(\w+)\s*;", text, re.M).group(1)
+    font["data"] = bytes(int_list(array_body(text, "data_")))
+
+    values = int_list(array_body(text, "kerns_"))
+    font["kerns"] = list(zip(values[0::2], values[1::2]))
+
+    values = int_list(array_body(text, "classesDefs_"))
+    font["classes"] = [
+        (values[i], (values[i + 1], values[i + 2])) for i in range(0, len(values), 3)
+    ]
+
+    matrix = array_body(text, "mKerns_").strip()[1:-1]  # Without the braces of the array
+    rows = re.findall(r"\{([^{}]*)\}", matrix)
+    font["mkerns"] = [int_list(row) for row in rows]
+
+    values = int_list(array_body(text, "ligatures_"))
+    font["ligatures"] = list(zip(values[0::2], values[1::2]))
+    return font
+
+
+def kept_glyphs(ttfont, codepoints, ligatures):
+    """Glyph IDs reached from the code points, closed over the ligatures' results."""
+    order = ttfont.getGlyphOrder()
+    cmap = ttfont.getBestCmap()
+    gids = {0} | {order.index(cmap[cp]) for cp in codepoints if cp in cmap}
+
+    changed = True
+    while changed:
+        changed = False
+        for key, result in ligatures:
+            if (key >> 16) in gids and (key & 0xFFFF) in gids and result not in gids:
+                gids.add(result)
+                changed = True
+    return gids
+
+
+def subset_font(data, codepoints, gids):
+    """Return the subset font bytes and the old to new glyph ID map."""
+    original_order = TTFont(io.BytesIO(data)).getGlyphOrder()
+
+    # The glyph bounding boxes are kept as is: TrueType places the outlines from their xMin
+    # and the horizontal metrics, rebuilding them would move some glyphs.
+    ttfont = TTFont(io.BytesIO(data), recalcBBoxes=False)
+    options = subset.Options()
+    options.layout_features = []
+    options.drop_tables += ["GSUB", "GPOS", "GDEF"]
+    options.notdef_outline = True
+    options.recalc_bounds = False
+
+    subsetter = subset.Subsetter(options)
+    subsetter.populate(unicodes=codepoints, gids=sorted(gids))
+    subsetter.subset(ttfont)
+
+    # Glyph names survive the subsetting of the in-memory font: they link both orders
+    old_ids = {name: gid for gid, name in enumerate(original_order)}
+    remap = {old_ids[name]: gid for gid, name in enumerate(ttfont.getGlyphOrder())}
+    if len(remap) >= PRIVATE_GLYPH_FLAG:
+        raise ValueError("glyph IDs from 0x8000 are reserved for the private face")
+
+    output = io.BytesIO()
+    ttfont.save(output)
+    return output.getvalue(), remap
+
+
+def remap_tables(font, remap):
+    def pair(key):
+        first, second = key >> 16, key & 0xFFFF
+        if first in remap and second in remap:
+            return (remap[first] << 16) | remap[second]
+        return None
+
+    ligatures = []
+    for key, result in font["ligatures"]:
+        new_key = pair(key)
+        if new_key is not None and result in remap:
+            ligatures.append((new_key, remap[result]))
+
+    kerns = []
+    for key, kern in font["kerns"]:
+        new_key = pair(key)
+        if new_key is not None:
+            kerns.append((new_key, kern))
+
+    classes = [(remap[gid], defs) for gid, defs in font["classes"] if gid in remap]
+
+    # Binary searched by FontData::ligKern(): keep them sorted
+    font["ligatures"] = sorted(ligatures)
+    font["kerns"] = sorted(kerns)
+    font["classes"] = sorted(classes)
+
+
+def rows(items, per_row, indent=8):
+    lines = []
+    for i in range(0, len(items), per_row):
+        lines.append(" " * indent + ", ".join(items[i : i + per_row]))
+    return ",\n".join(lines)
+
+
+def write_header(font, source, spec):
+    mkerns = font["mkerns"]
+    columns = len(mkerns[0]) if mkerns else 0
+    now = datetime.datetime.now().strftime("%Y-%m-%d %H:%M:%S")
+
+    def array(decl, items, per_row, brace=True):
+        open_, close = ("{{", "}}") if brace else ("{", "}")
+        body = rows(items, per_row)
+        body = body + "\n" if body else ""
+        return f"    const std::array<{decl} = {open_}\n{body}    {close};\n"
+
+    data = [f"0x{b:02x}" for b in font["data"]]
+    kerns = [f"{{ {k:9d}, {v:3d} }}" for k, v in font["kerns"]]
+    classes = [f"{{{g:4d}, {{{c1:2d},{c2:2d}}}}}" for g, (c1, c2) in font["classes"]]
+    matrix = ["{" + ",".join(f"{v:4d}" for v in row) + "}" for row in mkerns]
+    ligatures = [f"{{ {k:9d}, {v:4d} }}" for k, v in font["ligatures"]]
+
+    out = io.StringIO()
+    out.write(f"// ----- TTF Binary Font [ {font['name']} ] -----\n")
+    out.write("//\n")
+    out.write(f"//  Date: {now}\n")
+    out.write("//\n")
+    out.write(f"// Generated by tools/ttf_subset.py from {source}\n")
+    out.write(f"// Unicode ranges: {spec}\n")
+    out.write("//\n\n")
+    out.write("#pragma once\n\n")
+    out.write("// clang-format off\n\n")
+    out.write("#include <array>\n#include <cstdint>\n#include <utility>\n\n")
+    out.write("#if CONFIG_TINYFONT_TTF\n\n")
+    out.write("const struct {\n")
+    out.write(array(f"uint8_t, {len(data)}> data_", data, 16, brace=False))
+    out.write("\n")
+    out.write(array(f"std::pair<uint32_t, int16_t>, {len(kerns)}> kerns_", kerns, 5))
+    out.write("\n")
+    out.write(
+        array(
+            f"std::pair<uint16_t, std::pair<uint16_t, uint16_t>>, {len(classes)}> classesDefs_",
+            classes,
+            6,
+        )
+    )
+    out.write("\n")
+    out.write(array(f"std::array<int16_t, {columns}>, {len(matrix)}> mKerns_", matrix, 1))
+    out.write("\n")
+    out.write(array(f"std::pair<uint32_t, uint16_t>, {len(ligatures)}> ligatures_", ligatures, 5))
+    out.write(f"}} {font['name']};\n\n")
+    out.write("#endif\n\n")
+    out.write("// clang-format on\n")
+    return out.getvalue()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument(
+        "--unicodes", required=True, help="code point ranges, e.g. U+0020-007E,U+00A0-017F"
+    )
+    parser.add_argument("input", help="font header to read")
+    parser.add_argument("output", help="font header to write, can be the input one")
+    args = parser.parse_args()
+
+    with open(args.input, encoding="utf-8") as f:
+        font = parse_header(f.read())
+
+    codepoints = sorted(set(parse_unicodes(args.unicodes)) | set(ALWAYS_KEPT))
+    gids = kept_glyphs(TTFont(io.BytesIO(font["data"])), codepoints, font["ligatures"])
+
+    full_size = len(font["data"])
+    font["data"], remap = subset_font(font["data"], codepoints, gids)
+    remap_tables(font, remap)
+
+    with open(args.output, "w", encoding="utf-8") as f:
+        f.write(write_header(font, args.input, args.unicodes))
+
+    print(
+        f"{font['name']}: {len(remap)} glyphs, {full_size} -> {len(font['data'])} bytes, "
+        f"{len(font['ligatures'])} ligatures, {len(font['kerns'])} kerning pairs, "
+        f"{len(font['classes'])} class definitions"
+    )
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())